@@ -3,13 +3,29 @@
 
 // Bibliotecas necessárias
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <time.h>
+#include <string.h>
 #include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/stdio_usb.h"
+#include "pico/flash.h"
 #include "hardware/i2c.h"
 #include "hardware/adc.h"
+#include "hardware/uart.h"
+#include "hardware/sync.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/scb.h"
+#include "hardware/vreg.h"
 #include "ws2812.pio.h"
 #include "ssd1306.h"
+#include "seqlock.h"
+#include "planejador.h"
+#include "dither.h"
+#include "console.h"
+#include "snapshot.h"
 
 // Definindo os pinos dos leds
 #define BLUE 12
@@ -34,35 +50,227 @@
 #define I2C_SDA 14
 #define I2C_SCL 15
 #define ENDERECO 0x3C
+#define I2C_HZ_PADRAO (400 * 1000)
+
+// WS2812
+#define WS2812_FREQ 800000
+
+// UART do segundo jogador (mesma UART do stdio, que só é usada para saída)
+#define UART_JOGADOR uart0
 
 // Display
 ssd1306_t ssd;
 char timer[4];
 
+// Painel auxiliar opcional com o tempo e as vítimas restantes. Em outra porta
+// I2C ele transfere junto com o principal; na mesma porta, logo depois dele.
+#ifndef PAINEL_HUD
+#define PAINEL_HUD 0
+#endif
+#ifndef HUD_PORTA
+#define HUD_PORTA I2C_PORT
+#endif
+#ifndef HUD_SDA
+#define HUD_SDA 8  // Pinos usados só quando HUD_PORTA é diferente de I2C_PORT
+#endif
+#ifndef HUD_SCL
+#define HUD_SCL 9
+#endif
+#ifndef HUD_ENDERECO
+#define HUD_ENDERECO 0x3D
+#endif
+#ifndef HUD_ALTURA
+#define HUD_ALTURA 32
+#endif
+#ifndef HUD_CONTROLADOR
+#define HUD_CONTROLADOR SSD1306_CONTROLLER
+#endif
+
+ssd1306_t hud;
+ssd1306_t *paineis[2] = { &ssd };
+uint num_paineis = 1;
+
 // Constantes
 #define MAX_VITIMAS 5
+#define MAX_GRAVACAO 1024  // Passos de entrada guardados para o replay
+#define MAX_CAPTURA 256    // Passos guardados por captura de profiling
 #define DRONE_SIZE 8
 #define VITIMA_SIZE 4
+#define MAX_DRONES 2
+#define ORCAMENTO_PLANO 256  // Máscaras do planejador processadas por quadro
+#define TEMPO_OCIOSO_US 30000000  // Inatividade na tela inicial antes do repouso
+#define DITHER_BITS 2      // Intensidades das vítimas: 2^bits - 1 subquadros por ciclo
+
+// Perfil de desempenho inicial, também escolhido pelo joystick na tela inicial
+#ifndef PERFIL_INICIAL
+#define PERFIL_INICIAL 0
+#endif
+
+// Perfis de desempenho: clock do sistema, tensão do núcleo e I2C do display
+typedef struct {
+    const char *nome;
+    uint32_t sys_khz;
+    enum vreg_voltage vreg;
+    uint32_t i2c_hz;
+} perfil_t;
+
+static const perfil_t perfis[] = {
+    { "PADRAO", 125000, VREG_VOLTAGE_DEFAULT, 400 * 1000 },
+    { "RAPIDO", 200000, VREG_VOLTAGE_DEFAULT, 1000 * 1000 },
+    { "TURBO",  250000, VREG_VOLTAGE_1_20,    1000 * 1000 },
+};
+#define NUM_PERFIS (int)(sizeof(perfis) / sizeof(perfis[0]))
+
+// Modos de jogo, alternados com o botão B na tela inicial
+typedef enum {
+    MODO_UM_DRONE,
+    MODO_IA,
+    MODO_UART,
+    NUM_MODOS
+} modo_drones_t;
+
+// Posição publicada por cada drone
+typedef struct {
+    int x, y;
+} drone_pos_t;
+
+// Snapshot protegido por seqlock: só o core que controla o drone escreve,
+// o renderizador lê sem bloquear
+typedef struct {
+    seqlock_t lock;
+    drone_pos_t pos;
+} drone_snapshot_t;
+
+// Amostra de uma captura de profiling, uma por passo do jogo
+typedef struct {
+    uint32_t logica_us;
+    uint32_t subquadros;
+    uint32_t barramento_us;
+} amostra_t;
+
+// Configuração ajustável pelo console USB
+int num_vitimas = MAX_VITIMAS;
+int limite_tempo = 60;
+int passo_drone = 4;
+int passo_jogo_ms = 200;  // Intervalo entre passos da lógica do jogo
 
 // Variáveis globais
+int passo_partida = 4;  // passo_drone copiado no início de cada partida
+volatile int passo_ms_partida = 200;  // passo_jogo_ms copiado no início de cada partida, lido pelos dois cores
 int posx[MAX_VITIMAS];
 int posy[MAX_VITIMAS];
-bool vitima_ativa[MAX_VITIMAS];
-int total_resgatadas = 0;
+volatile bool vitima_ativa[MAX_VITIMAS];
+volatile int total_resgatadas = 0;
+int vitimas_partida = MAX_VITIMAS;
+int resgatadas_por[MAX_DRONES];
 int dronex, droney;
-bool jogo_ativo = false;
+volatile bool jogo_ativo = false;
 volatile bool botao_pressionado_flag = false;
 volatile bool tocar_som_inicio_flag = false;
 absolute_time_t ultimo_press = 0;
 
+// Estado compartilhado entre os cores
+drone_snapshot_t drones[MAX_DRONES];
+volatile modo_drones_t modo_drones = MODO_UM_DRONE;
+volatile uint32_t partida = 0;  // Incrementado a cada novo jogo
+volatile int drone2_inicio_x, drone2_inicio_y;
+spin_lock_t *trava_vitimas;
+
+// Piloto automático (modo demonstração, B pressionado durante o boot)
+bool piloto_automatico = false;
+planejador_t plano;
+int etapa_rota = 0;
+int quadros_plano = 0;
+uint32_t tempo_plano_us = 0;
+
+// Perfil de desempenho ativo e medições de quadro
+int perfil_atual = 0;
+uint32_t i2c_hz_atual = I2C_HZ_PADRAO;
+uint32_t quadros_seg = 0;
+uint32_t subquadros_seg = 0;
+uint32_t barramento_seg_us = 0;
+
+// Vítimas com intensidade (pulso e neblina) via dithering temporal
+dither_t dither;
+uint32_t passo_jogo = 0;
+
+// Fundo do passo (cena sem vítimas nem drones) e o contorno do drone 2 que
+// está no framebuffer, apagado com o fundo quando o core 1 move o drone
+uint8_t fundo[WIDTH * HEIGHT / 8 + 1];
+drone_pos_t contorno;
+bool contorno_desenhado = false;
+
+// Gravação das entradas do drone 1 para o replay, com a configuração que
+// muda o sorteio ou o caminho da partida gravada
+uint8_t gravacao[MAX_GRAVACAO];
+int passos_gravados = 0;
+int passo_replay = 0;
+uint32_t semente_partida, semente_gravada;
+int vitimas_gravadas, passo_gravado, passo_ms_gravado;
+modo_drones_t modo_gravado;
+bool replay_pedido = false;
+bool reproduzindo = false;
+bool gravando = false;
+bool resgate_gravado = false;
+bool segundo_gravado = false;  // O relógio do jogo avançou no fim do passo reproduzido
+int entrada_x, entrada_y;  // Direção do passo atual, gravada junto com o resgate
+
+// Captura de profiling pelo console
+amostra_t captura[MAX_CAPTURA];
+int amostras = 0;
+bool capturando = false;
+bool redesenhar_tela_inicial = false;
+
+// Efeitos sonoros desligados (roteiro de teste)
+bool mudo = false;
+
+// Repouso na tela inicial
+volatile bool em_repouso = false;
+volatile bool medir_despertar = false;
+absolute_time_t despertar_em;
+
 // Prototipação das funções
+bool executar_passo(int);
 bool update_timer(int, int);
+void desenhar_timer(int);
 void draw_object(int, int, int);
 void posicionar_vitimas();
+void desenhar_jogo();
 void desenhar_vitimas();
-void posicionar_drone();
+void posicionar_drone(int *, int *);
 void mover_drone();
+bool aplicar_movimento(int *, int *, int, int);
+void direcao_para(int, int, int, int, int *, int *);
+void direcao_joystick(int *, int *);
+void direcao_piloto(int *, int *);
+void direcao_replay(int *, int *);
+uint8_t codificar_passo(int, int, bool);
+void gravar_passo(int, int, bool);
+void gravar_segundo();
+void iniciar_console();
+void iniciar_jogo();
+void iniciar_jogo_no_laco();
+void desenhar_tela_inicial();
+void repousar_ate_botao();
+void reportar_despertar();
+void apagar_matriz();
+void iniciar_hud();
+void desenhar_hud(int);
+void aplicar_perfil(int);
+bool painel_responde(ssd1306_t *);
+uint32_t enviar_quadro();
+bool enviar_alteracoes(uint32_t *);
 void verificar_resgate();
+bool reivindicar_vitima(int, int, uint32_t);
+void resgatar_sob(int, int, int, uint32_t);
+void publicar_drone(int, int, int);
+drone_pos_t ler_drone(int);
+void guardar_fundo();
+void restaurar_fundo(int, int, int, int);
+void desenhar_subquadro();
+bool mover_drone_ia(int *, int *);
+bool mover_drone_uart(int *, int *);
+void core1_drone2();
 void irq_buttons(uint, uint32_t);
 bool checar_vitoria();
 void atualizar_led_azul();
@@ -94,6 +302,9 @@ int main() {
     // Botões
     gpio_init(BBUTTON); gpio_set_dir(BBUTTON, GPIO_IN); gpio_pull_up(BBUTTON);
     gpio_init(ABUTTON); gpio_set_dir(ABUTTON, GPIO_IN); gpio_pull_up(ABUTTON);
+    sleep_ms(10); // Estabiliza os pull-ups antes de ler o modo de boot
+    piloto_automatico = !gpio_get(BBUTTON);
+    if (piloto_automatico) printf("[DEMO] Piloto automatico ativado.\n");
     gpio_set_irq_enabled_with_callback(BBUTTON, GPIO_IRQ_EDGE_FALL, true, &irq_buttons);
     gpio_set_irq_enabled_with_callback(ABUTTON, GPIO_IRQ_EDGE_FALL, true, &irq_buttons);
 
@@ -102,56 +313,94 @@ int main() {
     gpio_init(BBUZZER); gpio_set_dir(BBUZZER, GPIO_OUT);
 
     // Display OLED
-    i2c_init(I2C_PORT, 400 * 1000);
+    i2c_init(I2C_PORT, I2C_HZ_PADRAO);
     gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
     gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
     gpio_pull_up(I2C_SDA); gpio_pull_up(I2C_SCL);
     ssd1306_init(&ssd, WIDTH, HEIGHT, false, ENDERECO, I2C_PORT);
     ssd1306_config(&ssd);
     ssd1306_send_data(&ssd);
+    iniciar_hud();
+    dither_init(&dither, DITHER_BITS);
 
     // WS2812
     PIO pio = pio0;
     uint sm = 0;
     uint offset = pio_add_program(pio, &ws2812_program);
-    ws2812_program_init(pio, sm, offset, LED_MATRIX, 800000, false);
+    ws2812_program_init(pio, sm, offset, LED_MATRIX, WS2812_FREQ, false);
+
+    // Perfil de desempenho escolhido na compilação
+    aplicar_perfil(PERFIL_INICIAL);
+    iniciar_console();
+
+    // Segundo drone no core 1
+    trava_vitimas = spin_lock_instance(spin_lock_claim_unused(true));
+    multicore_launch_core1(core1_drone2);
 
     int count = 0; // Contador de tempo
-    int x = 0;
     absolute_time_t ultimo_tempo = get_absolute_time();
+    absolute_time_t tela_inicial_desde = get_absolute_time();
     bool som_tela_inicial_tocado = false;
+    int modo_desenhado = -1; // Modo mostrado na tela inicial, -1 para redesenhar
+    int joystick_anterior = 0;
 
     while (true) {
+        console_poll();
+
         if (!jogo_ativo) {
             if (!som_tela_inicial_tocado) {
                 som_tela_inicial();
                 som_tela_inicial_tocado = true;
+                tela_inicial_desde = get_absolute_time();
+                modo_desenhado = -1;
+            }
+
+            // No modo demonstração o jogo reinicia sozinho
+            if (piloto_automatico && absolute_time_diff_us(tela_inicial_desde, get_absolute_time()) >= 2000000) {
+                iniciar_jogo_no_laco();
+                continue;
             }
             
-            // Tela inicial
-            ssd1306_fill(&ssd, false);
-            ssd1306_rect(&ssd, 0, 0, 128, 64, true, false); 
-            ssd1306_draw_string(&ssd, "BitDogRescue", 16, 12);
-            ssd1306_draw_string(&ssd, "pressione A", 20, 36);
-            ssd1306_draw_string(&ssd, "para iniciar", 18, 46);
-            ssd1306_send_data(&ssd);
-            show_numbers(0);
+            // Repousa após um tempo sem botões pressionados
+            absolute_time_t ultima_atividade = absolute_time_diff_us(tela_inicial_desde, ultimo_press) > 0 ? ultimo_press : tela_inicial_desde;
+            if (!piloto_automatico && absolute_time_diff_us(ultima_atividade, get_absolute_time()) >= TEMPO_OCIOSO_US) {
+                repousar_ate_botao();
+                tela_inicial_desde = get_absolute_time();
+                modo_desenhado = -1;
+                continue;
+            }
+
+            // Joystick para os lados troca o perfil de desempenho
+            int dir_x, dir_y;
+            direcao_joystick(&dir_x, &dir_y);
+            if (dir_x != 0 && dir_x != joystick_anterior) {
+                aplicar_perfil((perfil_atual + dir_x + NUM_PERFIS) % NUM_PERFIS);
+                tela_inicial_desde = get_absolute_time();
+                modo_desenhado = -1;
+            }
+            joystick_anterior = dir_x;
+
+            // A tela inicial só é reenviada quando muda
+            if (modo_desenhado != modo_drones || redesenhar_tela_inicial) {
+                modo_desenhado = modo_drones;
+                redesenhar_tela_inicial = false;
+                desenhar_tela_inicial();
+                enviar_quadro();
+                reportar_despertar();
+                show_numbers(0);
+            }
             count = 0;
+            sleep_ms(20);
         } else {
-            ssd1306_fill(&ssd, false);
-            snprintf(timer, sizeof(timer), "%d", count);
-            ssd1306_rect(&ssd, 0, 0, 128, 64, true, false);
-
-            // Move o drone e verifica se está sobre uma vítima e a possibilidade de resgate
-            mover_drone();
-            atualizar_led_azul();
-            verificar_resgate();
-            
-            // Desenha o drone e as vítimas e atualiza a matriz de LEDs
-            desenhar_vitimas();
-            draw_object(dronex, droney, DRONE_SIZE);
-            atualizar_matriz_led();
-            jogo_ativo = update_timer(count, x); // Verifica se o tempo esgotou
+            uint32_t inicio_passo = time_us_32();
+            uint32_t subquadros_passo = 0, barramento_passo_us = 0;
+
+            jogo_ativo = executar_passo(count);
+            if (!jogo_ativo) {
+                // Depois dos 5 s da tela de derrota em update_timer, redesenha a tela inicial
+                tela_inicial_desde = get_absolute_time();
+                modo_desenhado = -1;
+            }
 
             if (tocar_som_inicio_flag) {
                 som_inicio_jogo();
@@ -171,6 +420,8 @@ int main() {
                 // mensagem uart
                 printf("[FIM] Todas as vítimas foram salvas!\n");
                 printf("[TEMPO] Missao concluida em %dmin %ds.\n", count / 60, count % 60);
+                if (modo_drones != MODO_UM_DRONE)
+                    printf("[PLACAR] Drone 1: %d, drone 2: %d\n", resgatadas_por[0], resgatadas_por[1]);
                 sleep_ms(5000);
                 gpio_put(GREEN, false);
                 
@@ -180,28 +431,79 @@ int main() {
                 continue;
             }
 
-            ssd1306_send_data(&ssd);
+            // Até o próximo passo, gera subquadros de dithering em sincronia com
+            // o envio; as vítimas ficam por baixo e os drones são recompostos por
+            // cima, e cada envio leva só as colunas alteradas. Só conta como
+            // subquadro o que foi enviado: as fases em xadrez fazem toda vítima em
+            // nível parcial mudar a cada fase, então um subquadro sem alterações
+            // significa cena parada, e o resto do passo é esperado dormindo.
+            uint32_t logica_us = time_us_32() - inicio_passo;
+            absolute_time_t proximo_passo = make_timeout_time_ms(passo_ms_partida);
+            guardar_fundo();
+            while (jogo_ativo && !time_reached(proximo_passo)) {
+                desenhar_subquadro();
+                if (!enviar_alteracoes(&barramento_passo_us)) {
+                    sleep_until(proximo_passo);
+                    break;
+                }
+                subquadros_passo++;
+                dither_next(&dither);
+                reportar_despertar();
+            }
+            barramento_seg_us += barramento_passo_us;
+            subquadros_seg += subquadros_passo;
+            quadros_seg++;
+            passo_jogo++;
+
+            if (capturando && amostras < MAX_CAPTURA)
+                captura[amostras++] = (amostra_t){ logica_us, subquadros_passo, barramento_passo_us };
 
-            if (absolute_time_diff_us(ultimo_tempo, get_absolute_time()) >= 1000000) {
+            // O relógio do jogo avança com os segundos do sistema e o avanço é
+            // gravado no passo; no replay ele segue a gravação, para que as
+            // entradas caiam nos mesmos segundos mesmo com outro ritmo
+            bool segundo = absolute_time_diff_us(ultimo_tempo, get_absolute_time()) >= 1000000;
+            if (reproduzindo ? segundo_gravado : segundo) {
                 count++;
+                gravar_segundo();
+            }
+
+            if (segundo) {
                 ultimo_tempo = get_absolute_time();
+
+                printf("[PERF] %s: %lu quadros/s, %lu subquadros/s (dithering precisa de %lu), barramento %lu us/subquadro\n",
+                       perfis[perfil_atual].nome, (unsigned long)quadros_seg, (unsigned long)subquadros_seg,
+                       (unsigned long)dither_required_rate(&dither), (unsigned long)(barramento_seg_us / MAX(subquadros_seg, 1u)));
+                quadros_seg = 0;
+                subquadros_seg = 0;
+                barramento_seg_us = 0;
             }
 
-            sleep_ms(200);
+            if (!jogo_ativo) sleep_ms(passo_ms_partida);
         }
     }
 }
 
+// Um passo da lógica do jogo: move o drone, verifica o resgate e desenha a
+// cena do passo. Retorna false quando o tempo esgotou.
+bool executar_passo(int tempo) {
+    // Move o drone e verifica se está sobre uma vítima e a possibilidade de resgate
+    mover_drone();
+    publicar_drone(0, dronex, droney);
+    atualizar_led_azul();
+    verificar_resgate();
+
+    // Desenha a cena e atualiza a matriz de LEDs
+    snprintf(timer, sizeof(timer), "%d", tempo);
+    desenhar_jogo();
+    atualizar_matriz_led();
+    desenhar_hud(tempo);
+    return update_timer(tempo, 0); // Verifica se o tempo esgotou
+}
+
 // Atualiza o timer na tela e verifica se o tempo esgotou
 bool update_timer(int tempo, int x) {
-    // Move o contador para a esquerda baseado na quantidade de dígitos
-    if (tempo <= 60) {
-        if ((int)(floor(log10(tempo)) + 1) == 1 || tempo == 0)
-            x = 119;
-        else if ((int)(floor(log10(tempo) + 1)) == 2)
-            x = 111;
-
-        ssd1306_draw_string(&ssd, timer, x, 2);
+    if (tempo <= limite_tempo) {
+        desenhar_timer(tempo);
     } else {
         // Tela de derrota
         ssd1306_fill(&ssd, false);
@@ -220,6 +522,19 @@ bool update_timer(int tempo, int x) {
     return true;
 }
 
+// Desenha o timer, movendo o contador para a esquerda baseado na quantidade de dígitos
+void desenhar_timer(int tempo) {
+    int x;
+    if ((int)(floor(log10(tempo)) + 1) == 1 || tempo == 0)
+        x = 119;
+    else if ((int)(floor(log10(tempo) + 1)) == 2)
+        x = 111;
+    else
+        x = 103;
+
+    ssd1306_draw_string(&ssd, timer, x, 2);
+}
+
 // Desenha um objeto na tela (vítima ou drone)
 void draw_object(int x, int y, int size) {
     ssd1306_rect(&ssd, y, x, size, size, true, true);
@@ -227,9 +542,13 @@ void draw_object(int x, int y, int size) {
 
 // Posiciona as vítimas em posições aleatórias na tela, evitando sobreposição
 void posicionar_vitimas() {
-    srand(time_us_32());
+    srand(semente_partida);
     
     for (int i = 0; i < MAX_VITIMAS; i++) {
+        vitima_ativa[i] = false;
+    }
+
+    for (int i = 0; i < vitimas_partida; i++) {
         bool pos_valida = false;
         
         while (!pos_valida) {
@@ -256,28 +575,47 @@ void posicionar_vitimas() {
     }
 }
 
-// Desenha as vítimas na tela
+// Desenha a cena do passo atual no framebuffer, sem o timer; as vítimas e
+// os drones entram a cada subquadro
+void desenhar_jogo() {
+    ssd1306_fill(&ssd, false);
+    ssd1306_rect(&ssd, 0, 0, 128, 64, true, false);
+    desenhar_vitimas();
+    contorno_desenhado = false;
+}
+
+// Monta as vítimas como sprites de dithering: a intensidade cai com a
+// distância ao drone (neblina) e pulsa um nível a cada passo do jogo
 void desenhar_vitimas() {
-    for (int i = 0; i < MAX_VITIMAS; i++)
-        if (vitima_ativa[i])
-            draw_object(posx[i], posy[i], VITIMA_SIZE);
+    const uint8_t maximo = dither.subframes;
+
+    dither_clear(&dither);
+    for (int i = 0; i < MAX_VITIMAS; i++) {
+        if (!vitima_ativa[i]) continue;
+
+        int dist = MAX(abs(dronex - posx[i]), abs(droney - posy[i]));
+        uint8_t nivel = dist < 24 ? maximo : dist < 56 ? (maximo * 2 + 2) / 3 : (maximo + 2) / 3;
+        if ((passo_jogo & 1) && nivel > 1) nivel--;
+
+        dither_add(&dither, posx[i], posy[i], VITIMA_SIZE, VITIMA_SIZE, nivel);
+    }
 }
 
-// Posiciona o drone em uma posição válida, longe das vítimas
-void posicionar_drone() {
+// Posiciona um drone em uma posição válida, longe das vítimas
+void posicionar_drone(int *x, int *y) {
     bool pos_valida = false;
     
     while (!pos_valida) {
         pos_valida = true;
 
         // Gera uma posição aleatória para o drone
-        dronex = (rand() % (118 - 8 + 1)) + 4;
-        droney = (rand() % (54 - 8 + 1)) + 8;
+        *x = (rand() % (118 - 8 + 1)) + 4;
+        *y = (rand() % (54 - 8 + 1)) + 8;
         
         // Verifica se a posição do drone não colide com as vítimas
-        for (int i = 0; i < MAX_VITIMAS; i++) {
-            int dx = abs(dronex - posx[i]);
-            int dy = abs(droney - posy[i]);
+        for (int i = 0; i < vitimas_partida; i++) {
+            int dx = abs(*x - posx[i]);
+            int dy = abs(*y - posy[i]);
             
             if (dx < DRONE_SIZE + 10 && dy < DRONE_SIZE + 10) {
                 pos_valida = false;
@@ -287,9 +625,81 @@ void posicionar_drone() {
     }
 }
 
-// Move o drone com base nos valores do joystick
+// Move o drone com base no joystick ou no piloto automático
 void mover_drone() {
-    const int passo = 4;
+    int dir_x, dir_y;
+
+    if (reproduzindo)
+        direcao_replay(&dir_x, &dir_y);
+    else if (piloto_automatico)
+        direcao_piloto(&dir_x, &dir_y);
+    else
+        direcao_joystick(&dir_x, &dir_y);
+    entrada_x = dir_x;
+    entrada_y = dir_y;
+
+    if (aplicar_movimento(&dronex, &droney, dir_x, dir_y))
+        som_mover_drone();
+}
+
+// Move um passo em cada eixo (-1, 0 ou 1) respeitando as bordas da tela
+bool aplicar_movimento(int *x, int *y, int dir_x, int dir_y) {
+    int novo_x = MIN(MAX(*x + dir_x * passo_partida, 4), 120);
+    int novo_y = MIN(MAX(*y + dir_y * passo_partida, 8), 56);
+    bool moveu = novo_x != *x || novo_y != *y;
+
+    *x = novo_x;
+    *y = novo_y;
+    return moveu;
+}
+
+// Direção de (x, y) até o alvo, com zona morta de meio passo
+void direcao_para(int x, int y, int alvo_x, int alvo_y, int *dir_x, int *dir_y) {
+    *dir_x = (alvo_x < x - passo_partida / 2) ? -1 : (alvo_x > x + passo_partida / 2) ? 1 : 0;
+    *dir_y = (alvo_y < y - passo_partida / 2) ? -1 : (alvo_y > y + passo_partida / 2) ? 1 : 0;
+}
+
+// Codifica a entrada de um passo em um byte: 2 bits por eixo e o resgate.
+// O bit 5 marca o passo em que o relógio do jogo avançou (gravar_segundo).
+uint8_t codificar_passo(int dir_x, int dir_y, bool resgate) {
+    return (dir_x + 1) | ((dir_y + 1) << 2) | (resgate << 4);
+}
+
+// Guarda a entrada do passo para o replay (a gravação para quando enche)
+void gravar_passo(int dir_x, int dir_y, bool resgate) {
+    if (!gravando) return;
+    if (passos_gravados >= MAX_GRAVACAO) {
+        gravando = false;
+        return;
+    }
+    gravacao[passos_gravados++] = codificar_passo(dir_x, dir_y, resgate);
+}
+
+// Marca no último passo gravado que o relógio do jogo avançou depois dele
+void gravar_segundo() {
+    if (gravando && passos_gravados > 0)
+        gravacao[passos_gravados - 1] |= 0x20;
+}
+
+// Reproduz as entradas gravadas na última partida, inclusive os resgates
+void direcao_replay(int *dir_x, int *dir_y) {
+    if (passo_replay >= passos_gravados) {
+        *dir_x = *dir_y = 0;
+        reproduzindo = false;
+        segundo_gravado = false;
+        printf("[REPLAY] Fim da gravacao (%d passos).\n", passos_gravados);
+        return;
+    }
+
+    uint8_t passo = gravacao[passo_replay++];
+    *dir_x = (passo & 0x3) - 1;
+    *dir_y = ((passo >> 2) & 0x3) - 1;
+    resgate_gravado = passo & 0x10;
+    segundo_gravado = passo & 0x20;
+}
+
+// Mapeia os valores do joystick para a direção do drone
+void direcao_joystick(int *dir_x, int *dir_y) {
     const int limiar_baixo = 1000;
     const int limiar_alto  = 3000;
 
@@ -298,64 +708,768 @@ void mover_drone() {
     adc_select_input(0);
     uint16_t val_y = adc_read();
 
-    // Mapeia os valores do joystick para o movimento do drone
-    if (val_x < limiar_baixo && dronex > 4) { dronex -= passo; som_mover_drone();}
-    else if (val_x > limiar_alto && dronex < 120) { dronex += passo; som_mover_drone();}
-    if (val_y < limiar_baixo && droney < 56) { droney += passo; som_mover_drone();} 
-    else if (val_y > limiar_alto && droney > 8) { droney -= passo; som_mover_drone();}
+    *dir_x = (val_x < limiar_baixo) ? -1 : (val_x > limiar_alto) ? 1 : 0;
+    *dir_y = (val_y < limiar_baixo) ? 1 : (val_y > limiar_alto) ? -1 : 0;
 }
 
-// Verifica se o drone está sobre uma vítima e atualiza o estado
+// Piloto automático: avança o planejamento dentro do orçamento do quadro e,
+// com a rota pronta, segue as vítimas na ordem planejada
+void direcao_piloto(int *dir_x, int *dir_y) {
+    *dir_x = *dir_y = 0;
+
+    if (!plano.pronto) {
+        uint32_t inicio = time_us_32();
+        bool pronto = planejador_passo(&plano, ORCAMENTO_PLANO);
+        tempo_plano_us += time_us_32() - inicio;
+        quadros_plano++;
+        if (!pronto) return;
+        printf("[PILOTO] Rota planejada em %d quadro(s), %lu us, custo %u.\n",
+               quadros_plano, (unsigned long)tempo_plano_us, plano.custo_total);
+    }
+
+    // Pula as vítimas que já foram resgatadas (inclusive pelo outro drone)
+    while (etapa_rota < plano.n && !vitima_ativa[plano.rota[etapa_rota]])
+        etapa_rota++;
+    if (etapa_rota >= plano.n) return;
+
+    int alvo = plano.rota[etapa_rota];
+    if (abs(dronex - posx[alvo]) < DRONE_SIZE && abs(droney - posy[alvo]) < DRONE_SIZE)
+        botao_pressionado_flag = true; // Resgata pelo mesmo caminho do botão B
+    else
+        direcao_para(dronex, droney, posx[alvo], posy[alvo], dir_x, dir_y);
+}
+
+// Verifica se o drone está sobre uma vítima e atualiza o estado. O pedido de
+// resgate é lido e limpo aqui, onde é consumido, e gravado junto com a direção
+// do passo; no replay vale o resgate gravado, não o botão.
 void verificar_resgate() {
-    if(!botao_pressionado_flag) return;
-    
+    uint32_t irq = save_and_disable_interrupts();
+    bool resgate = botao_pressionado_flag;
+    botao_pressionado_flag = false;
+    restore_interrupts(irq);
+
+    if (reproduzindo) {
+        resgate = resgate_gravado;
+        resgate_gravado = false;
+    }
+    gravar_passo(entrada_x, entrada_y, resgate);
+
+    if (resgate)
+        resgatar_sob(0, dronex, droney, partida);
+}
+
+// Tenta resgatar as vítimas sob o drone indicado na partida em que ele está
+void resgatar_sob(int drone, int x, int y, uint32_t partida_drone) {
     for (int i = 0; i < MAX_VITIMAS; i++) {
         // Verifica se o drone está sobre a vítima
-        if (vitima_ativa[i] && abs(dronex - posx[i]) < DRONE_SIZE && abs(droney - posy[i]) < DRONE_SIZE) {
-            vitima_ativa[i] = false;
-            total_resgatadas++;
-            
-            printf("[RESGATE] Vítima salva em %d, %d\n", posx[i], posy[i]);
+        if (vitima_ativa[i] && abs(x - posx[i]) < DRONE_SIZE && abs(y - posy[i]) < DRONE_SIZE) {
+            if (!reivindicar_vitima(i, drone, partida_drone)) continue; // O outro drone chegou primeiro
+
+            printf("[RESGATE] Drone %d salvou vítima em %d, %d\n", drone + 1, posx[i], posy[i]);
             som_resgate();
         }
     }
+}
 
-    botao_pressionado_flag = false;
+// Marca a vítima como resgatada pelo drone. O Cortex-M0+ não tem LDREX/STREX,
+// então o teste-e-limpa usa um spinlock de hardware do SIO; apenas as
+// reivindicações e o reinício passam por ele, o renderizador lê vitima_ativa[]
+// sem travar. Uma reivindicação feita na partida anterior é recusada.
+bool reivindicar_vitima(int i, int drone, uint32_t partida_drone) {
+    uint32_t irq = spin_lock_blocking(trava_vitimas);
+    bool ganhou = partida_drone == partida && vitima_ativa[i];
+    if (ganhou) {
+        vitima_ativa[i] = false;
+        total_resgatadas++;
+        resgatadas_por[drone]++;
+    }
+    spin_unlock(trava_vitimas, irq);
+    return ganhou;
+}
+
+// Publica a posição de um drone. O snapshot 0 só é escrito pelo core 0; o 1 é
+// escrito pelo core 1 e, no reinício, pelo core 0, sempre com a trava das vítimas
+void publicar_drone(int id, int x, int y) {
+    seqlock_escrita_inicio(&drones[id].lock);
+    drones[id].pos.x = x;
+    drones[id].pos.y = y;
+    seqlock_escrita_fim(&drones[id].lock);
+}
+
+// Lê uma cópia consistente da posição de um drone sem bloquear o escritor
+drone_pos_t ler_drone(int id) {
+    drone_pos_t pos;
+    uint32_t seq;
+    do {
+        seq = seqlock_leitura_inicio(&drones[id].lock);
+        pos = drones[id].pos;
+    } while (seqlock_leitura_repetir(&drones[id].lock, seq));
+    return pos;
+}
+
+// Guarda a cena do passo (borda e timer) para recompor o que fica sob o drone 2
+void guardar_fundo() {
+    memcpy(fundo, ssd.ram_buffer, MIN(ssd.bufsize, sizeof(fundo)));
+}
+
+// Devolve uma área do framebuffer ao fundo do passo
+void restaurar_fundo(int x0, int y0, int largura, int altura) {
+    for (int x = x0; x < MIN(x0 + largura, ssd.width); x++)
+        for (int y = y0; y < MIN(y0 + altura, ssd.height); y++)
+            ssd1306_pixel(&ssd, x, y, fundo[1 + x * ssd.pages + (y >> 3)] & (1 << (y & 7)));
+}
+
+// Compõe um subquadro sobre o fundo: vítimas no nível de dithering atual e os
+// drones por cima, a partir dos snapshots (o segundo apenas contornado). O core 1
+// pode mover o drone 2 no meio do passo, então o contorno anterior é apagado.
+void desenhar_subquadro() {
+    bool dois_drones = modo_drones != MODO_UM_DRONE;
+    drone_pos_t d2 = ler_drone(1);
+
+    if (contorno_desenhado && (!dois_drones || d2.x != contorno.x || d2.y != contorno.y)) {
+        restaurar_fundo(contorno.x, contorno.y, DRONE_SIZE, DRONE_SIZE);
+        contorno_desenhado = false;
+    }
+
+    dither_draw(&dither, &ssd);
+    drone_pos_t d1 = ler_drone(0);
+    draw_object(d1.x, d1.y, DRONE_SIZE);
+
+    if (dois_drones) {
+        ssd1306_rect(&ssd, d2.y, d2.x, DRONE_SIZE, DRONE_SIZE, true, false);
+        contorno = d2;
+        contorno_desenhado = true;
+    }
+}
+
+// IA do segundo drone: segue em direção à vítima ativa mais próxima
+bool mover_drone_ia(int *x, int *y) {
+    int alvo = -1;
+    int menor = 0;
+
+    for (int i = 0; i < MAX_VITIMAS; i++) {
+        if (!vitima_ativa[i]) continue;
+        int dist = abs(*x - posx[i]) + abs(*y - posy[i]);
+        if (alvo < 0 || dist < menor) {
+            alvo = i;
+            menor = dist;
+        }
+    }
+    if (alvo < 0) return false;
+
+    if (abs(*x - posx[alvo]) < DRONE_SIZE && abs(*y - posy[alvo]) < DRONE_SIZE)
+        return true;
+
+    int dir_x, dir_y;
+    direcao_para(*x, *y, posx[alvo], posy[alvo], &dir_x, &dir_y);
+    aplicar_movimento(x, y, dir_x, dir_y);
+    return false;
+}
+
+// Segundo jogador pela UART: w/a/s/d movem e espaço resgata
+bool mover_drone_uart(int *x, int *y) {
+    bool resgatar = false;
+
+    while (uart_is_readable(UART_JOGADOR)) {
+        switch (uart_getc(UART_JOGADOR)) {
+            case 'a': aplicar_movimento(x, y, -1, 0); break;
+            case 'd': aplicar_movimento(x, y, 1, 0); break;
+            case 'w': aplicar_movimento(x, y, 0, -1); break;
+            case 's': aplicar_movimento(x, y, 0, 1); break;
+            case ' ': resgatar = true; break;
+        }
+    }
+    return resgatar;
+}
+
+// Laço do segundo drone no core 1. A posição inicial é entregue pelo core 0
+// junto com o contador de partida; um passo que atravessou um reinício é
+// descartado sem publicar nem resgatar.
+void core1_drone2() {
+    uint32_t minha_partida = 0;
+    int x = 0, y = 0;
+
+    // Permite que o core 0 pare este core enquanto grava a flash
+    flash_safe_execute_core_init();
+
+    while (true) {
+        // Dorme junto com o core 0 para que o sono profundo desligue os clocks
+        if (em_repouso) {
+            scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+            while (em_repouso)
+                __wfe();
+            scb_hw->scr &= ~M0PLUS_SCR_SLEEPDEEP_BITS;
+            continue;
+        }
+
+        if (!jogo_ativo || modo_drones == MODO_UM_DRONE) {
+            sleep_ms(20);
+            continue;
+        }
+
+        if (minha_partida != partida) {
+            minha_partida = partida;
+            __dmb();
+            x = drone2_inicio_x;
+            y = drone2_inicio_y;
+        }
+
+        bool resgatar = (modo_drones == MODO_IA) ? mover_drone_ia(&x, &y) : mover_drone_uart(&x, &y);
+        uint32_t irq = spin_lock_blocking(trava_vitimas);
+        bool atual = minha_partida == partida;
+        if (atual) publicar_drone(1, x, y);
+        spin_unlock(trava_vitimas, irq);
+        if (atual && resgatar) resgatar_sob(1, x, y, minha_partida);
+
+        // Mesmo ritmo do drone 1
+        sleep_ms(passo_ms_partida);
+    }
 }
 
 // Verifica se todas as vítimas foram resgatadas
 bool checar_vitoria() {
-    return total_resgatadas == MAX_VITIMAS;
+    return total_resgatadas == vitimas_partida;
 }
 
 // Interrupção para os botões
 void irq_buttons(uint gpio, uint32_t event){
     absolute_time_t agr = get_absolute_time();
 
-    // Interrupção para o botão B
+    // Qualquer botão acorda do repouso; o B apenas acorda, sem trocar o modo
+    bool acordando = em_repouso;
+    if (acordando) {
+        em_repouso = false;
+        despertar_em = agr;
+        medir_despertar = true;
+    }
+
+    // Interrupção para o botão B: resgate durante o jogo, troca de modo na tela inicial
     if (gpio == BBUTTON && absolute_time_diff_us(ultimo_press, agr) > 250000){
-        botao_pressionado_flag = true;
+        if (jogo_ativo)
+            botao_pressionado_flag = true;
+        else if (!acordando)
+            modo_drones = (modo_drones + 1) % NUM_MODOS;
         ultimo_press = agr;
     }
 
     // Interrupção para o botão A
     if (gpio == ABUTTON && absolute_time_diff_us(ultimo_press, agr) > 250000){
-        jogo_ativo = true;
         ultimo_press = agr;
-        total_resgatadas = 0;
-        
-        // Inicializa o jogo
-        posicionar_vitimas();
-        posicionar_drone();
-        
-        gpio_put(RED, false);
-        gpio_put(GREEN, false);
-        
-        printf("[INICIO] Jogo iniciado.\n");
-        tocar_som_inicio_flag = true; 
+        iniciar_jogo();
+    }
+}
+
+// Inicia o jogo a partir do laço principal, com a interrupção dos botões
+// mascarada para que o botão A não reinicie o jogo no meio
+void iniciar_jogo_no_laco() {
+    irq_set_enabled(IO_IRQ_BANK0, false);
+    iniciar_jogo();
+    irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+// Desenha a tela inicial com o modo de jogo selecionado
+void desenhar_tela_inicial() {
+    ssd1306_fill(&ssd, false);
+    ssd1306_rect(&ssd, 0, 0, 128, 64, true, false); 
+    ssd1306_draw_string(&ssd, "BitDogRescue", 16, 12);
+    if (modo_drones == MODO_UM_DRONE)
+        ssd1306_draw_string(&ssd, "1 drone", 36, 24);
+    else if (modo_drones == MODO_IA)
+        ssd1306_draw_string(&ssd, "2 drones IA", 20, 24);
+    else
+        ssd1306_draw_string(&ssd, "2 drones UART", 12, 24);
+    ssd1306_draw_string(&ssd, "pressione A", 20, 36);
+    ssd1306_draw_string(&ssd, "para iniciar", 18, 46);
+    const char *nome = perfis[perfil_atual].nome;
+    ssd1306_draw_string(&ssd, nome, (128 - 8 * strlen(nome)) / 2, 54);
+}
+
+// Envia o framebuffer ao display e retorna o tempo gasto no barramento
+uint32_t enviar_quadro() {
+    uint32_t inicio = time_us_32();
+    ssd1306_send_data(&ssd);
+    return time_us_32() - inicio;
+}
+
+// Envia só as colunas alteradas de todos os painéis, soma o tempo gasto no
+// barramento e retorna false se não havia nada a enviar
+bool enviar_alteracoes(uint32_t *barramento_us) {
+    uint32_t inicio = time_us_32();
+    bool enviou = ssd1306_flush(paineis, num_paineis);
+    *barramento_us += time_us_32() - inicio;
+    return enviou;
+}
+
+// Configura o painel auxiliar, se habilitado, e o inclui nos envios
+void iniciar_hud() {
+#if PAINEL_HUD
+    if (HUD_PORTA != I2C_PORT) {
+        i2c_init(HUD_PORTA, I2C_HZ_PADRAO);
+        gpio_set_function(HUD_SDA, GPIO_FUNC_I2C);
+        gpio_set_function(HUD_SCL, GPIO_FUNC_I2C);
+        gpio_pull_up(HUD_SDA); gpio_pull_up(HUD_SCL);
+    }
+    ssd1306_init_controller(&hud, HUD_CONTROLADOR, WIDTH, HUD_ALTURA, false, HUD_ENDERECO, HUD_PORTA);
+    ssd1306_config(&hud);
+    ssd1306_fill(&hud, false);
+    ssd1306_send_data(&hud);
+    paineis[num_paineis++] = &hud;
+#endif
+}
+
+// Desenha o tempo e as vítimas restantes no painel auxiliar quando mudam
+void desenhar_hud(int tempo) {
+    static int tempo_anterior = -1, restantes_anterior = -1;
+    int restantes = vitimas_partida - total_resgatadas;
+    if (num_paineis < 2 || (tempo == tempo_anterior && restantes == restantes_anterior))
+        return;
+    tempo_anterior = tempo;
+    restantes_anterior = restantes;
+
+    char linha[17];
+    ssd1306_fill(&hud, false);
+    snprintf(linha, sizeof(linha), "Tempo %d/%d", tempo, limite_tempo);
+    ssd1306_draw_string(&hud, linha, 0, 0);
+    snprintf(linha, sizeof(linha), "Vitimas %d", restantes);
+    ssd1306_draw_string(&hud, linha, 0, 12);
+}
+
+// Troca o clock do sistema e recalcula tudo o que deriva dele. A tensão sobe
+// antes de acelerar e só desce depois de desacelerar. O áudio usa sleep_us,
+// que conta no timer de 1 MHz do clk_ref, então não depende do clk_sys.
+void aplicar_perfil(int id) {
+    const perfil_t *p = &perfis[id];
+
+    uart_default_tx_wait_blocking();
+    if (p->vreg > perfis[perfil_atual].vreg) {
+        vreg_set_voltage(p->vreg);
+        sleep_ms(1);
+    }
+    if (!set_sys_clock_khz(p->sys_khz, false)) {
+        // Continua no perfil atual, então a tensão também volta
+        if (p->vreg > perfis[perfil_atual].vreg)
+            vreg_set_voltage(perfis[perfil_atual].vreg);
+        printf("[PERF] %s: clock de %lu kHz indisponivel.\n", p->nome, (unsigned long)p->sys_khz);
+        return;
+    }
+    if (p->vreg < perfis[perfil_atual].vreg)
+        vreg_set_voltage(p->vreg);
+    perfil_atual = id;
+
+    // UART, I2C e PIO dividem clocks derivados do sistema
+    uart_set_baudrate(uart_default, PICO_DEFAULT_UART_BAUD_RATE);
+    pio_sm_set_clkdiv(pio0, 0, clock_get_hz(clk_sys) / (WS2812_FREQ * (float)(ws2812_T1 + ws2812_T2 + ws2812_T3)));
+
+    // Fast-mode Plus só fica em uma porta se todos os painéis dela continuarem
+    // respondendo; cada porta volta ao padrão separadamente
+    i2c_inst_t *portas[2] = { i2c0, i2c1 };
+    for (uint i = 0; i < 2; i++) {
+        bool usada = false, responde = true;
+        for (uint j = 0; j < num_paineis; j++)
+            usada |= paineis[j]->i2c_port == portas[i];
+        if (!usada) continue;
+
+        uint32_t hz = i2c_set_baudrate(portas[i], p->i2c_hz);
+        for (uint j = 0; j < num_paineis && responde; j++) {
+            if (paineis[j]->i2c_port == portas[i] && !painel_responde(paineis[j])) {
+                printf("[PERF] Painel 0x%02X nao responde a %lu kHz, I2C%u volta ao padrao.\n",
+                       paineis[j]->address, (unsigned long)(hz / 1000), i);
+                hz = i2c_set_baudrate(portas[i], I2C_HZ_PADRAO);
+                responde = false;
+            }
+        }
+        if (portas[i] == I2C_PORT)
+            i2c_hz_atual = hz;
+    }
+
+    printf("[PERF] Perfil %s: sys %lu kHz, I2C %lu kHz, quadro completo em %lu us\n", p->nome,
+           (unsigned long)(clock_get_hz(clk_sys) / 1000), (unsigned long)(i2c_hz_atual / 1000),
+           (unsigned long)enviar_quadro());
+}
+
+// Envia um comando inofensivo ao painel para verificar se ele reconhece o endereço
+bool painel_responde(ssd1306_t *painel) {
+    const uint8_t cmd[2] = { 0x80, SET_ENTIRE_ON };
+    return i2c_write_timeout_us(painel->i2c_port, painel->address, cmd, sizeof(cmd), false, 1000) == sizeof(cmd);
+}
+
+// Apaga os displays e os LEDs e dorme até um botão ser pressionado.
+// Sem host USB conectado, entra em sono profundo com os clocks dos periféricos
+// desligados; o banco de GPIO continua com clock para gerar a interrupção.
+// Com o USB conectado, só dorme com WFI para não derrubar o CDC.
+// Os botões ficam mascarados até em_repouso valer: um toque durante o
+// apagamento acorda a placa em vez de trocar o modo ou iniciar o jogo.
+void repousar_ate_botao() {
+    irq_set_enabled(IO_IRQ_BANK0, false);
+    for (uint i = 0; i < num_paineis; i++)
+        ssd1306_command(paineis[i], SET_DISP | 0x00);
+    apagar_matriz();
+    gpio_put(RED, false);
+    gpio_put(GREEN, false);
+    gpio_put(BLUE, false);
+
+    bool profundo = !stdio_usb_connected();
+    printf("[IDLE] Repouso %s.\n", profundo ? "profundo" : "leve (USB conectado)");
+    uart_default_tx_wait_blocking();
+
+    em_repouso = true;
+    irq_set_enabled(IO_IRQ_BANK0, true);
+    if (profundo) {
+        clocks_hw->sleep_en0 = CLOCKS_SLEEP_EN0_CLK_SYS_IO_BITS |
+                               CLOCKS_SLEEP_EN0_CLK_SYS_PADS_BITS |
+                               CLOCKS_SLEEP_EN0_CLK_SYS_BUSFABRIC_BITS |
+                               CLOCKS_SLEEP_EN0_CLK_SYS_PLL_SYS_BITS;
+        clocks_hw->sleep_en1 = CLOCKS_SLEEP_EN1_CLK_SYS_XIP_BITS;
+        scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+    }
+
+    while (em_repouso)
+        __wfi();
+
+    // Restaura os clocks e acorda o core 1, que dorme em WFE
+    if (profundo) {
+        scb_hw->scr &= ~M0PLUS_SCR_SLEEPDEEP_BITS;
+        clocks_hw->sleep_en0 = 0xFFFFFFFF;
+        clocks_hw->sleep_en1 = 0xFFFFFFFF;
+    }
+    __sev();
+    for (uint i = 0; i < num_paineis; i++)
+        ssd1306_command(paineis[i], SET_DISP | 0x01);
+}
+
+// Informa o tempo entre o botão que acordou a placa e o primeiro quadro enviado
+void reportar_despertar() {
+    if (!medir_despertar) return;
+    medir_despertar = false;
+    printf("[IDLE] Despertar ate o primeiro quadro: %lld us\n",
+           (long long)absolute_time_diff_us(despertar_em, get_absolute_time()));
+}
+
+// Comandos do console USB. O valor só é escrito se for um número inteiro
+// dentro da faixa, para que um comando recusado não mude a configuração.
+static bool ler_argumento(int argc, char **argv, int minimo, int maximo, int *valor) {
+    char *fim = NULL;
+    long lido = argc >= 2 ? strtol(argv[1], &fim, 10) : 0;
+    if (argc < 2 || fim == argv[1] || *fim != '\0' || lido < minimo || lido > maximo) {
+        printf("[CONSOLE] Uso: %s <%d a %d>\n", argv[0], minimo, maximo);
+        return false;
+    }
+    *valor = lido;
+    return true;
+}
+
+static void cmd_ajuda(int argc, char **argv) {
+    console_help();
+}
+
+static void cmd_vitimas(int argc, char **argv) {
+    if (ler_argumento(argc, argv, 1, MAX_VITIMAS, &num_vitimas))
+        printf("[CONSOLE] %d vitimas a partir da proxima partida.\n", num_vitimas);
+}
+
+static void cmd_tempo(int argc, char **argv) {
+    if (ler_argumento(argc, argv, 10, 999, &limite_tempo))
+        printf("[CONSOLE] Limite de tempo: %d s.\n", limite_tempo);
+}
+
+static void cmd_velocidade(int argc, char **argv) {
+    if (ler_argumento(argc, argv, 1, 8, &passo_drone))
+        printf("[CONSOLE] Drone anda %d pixels por passo a partir da proxima partida.\n", passo_drone);
+}
+
+static void cmd_fps(int argc, char **argv) {
+    int fps;
+    if (ler_argumento(argc, argv, 1, 50, &fps)) {
+        passo_jogo_ms = 1000 / fps;
+        printf("[CONSOLE] Passo do jogo: %d ms a partir da proxima partida.\n", passo_jogo_ms);
     }
 }
 
+static void cmd_clock(int argc, char **argv) {
+    int id;
+    if (ler_argumento(argc, argv, 0, NUM_PERFIS - 1, &id)) {
+        aplicar_perfil(id);
+        redesenhar_tela_inicial = true;
+    }
+}
+
+static void cmd_fb(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "hex") == 0)
+        snapshot_print_hex(&ssd);
+    else if (argc >= 2 && strcmp(argv[1], "pbm") == 0)
+        snapshot_print_pbm(&ssd);
+    else
+        printf("[CONSOLE] Uso: fb <hex|pbm>\n");
+}
+
+// Inicia ou encerra a captura; ao encerrar imprime as amostras em CSV e o resumo
+static void cmd_captura(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "iniciar") == 0) {
+        amostras = 0;
+        capturando = true;
+        printf("[CAPTURA] Iniciada.\n");
+    } else if (argc >= 2 && strcmp(argv[1], "parar") == 0) {
+        capturando = false;
+        uint32_t pior_logica = 0, pior_barramento = 0, total_subquadros = 0;
+
+        printf("passo,logica_us,subquadros,barramento_us\n");
+        for (int i = 0; i < amostras; i++) {
+            printf("%d,%lu,%lu,%lu\n", i, (unsigned long)captura[i].logica_us,
+                   (unsigned long)captura[i].subquadros, (unsigned long)captura[i].barramento_us);
+            pior_logica = MAX(pior_logica, captura[i].logica_us);
+            pior_barramento = MAX(pior_barramento, captura[i].barramento_us);
+            total_subquadros += captura[i].subquadros;
+        }
+        printf("[CAPTURA] %d passos, pior logica %lu us, pior barramento %lu us, %lu subquadros\n", amostras,
+               (unsigned long)pior_logica, (unsigned long)pior_barramento, (unsigned long)total_subquadros);
+    } else {
+        printf("[CONSOLE] Uso: captura <iniciar|parar>\n");
+    }
+}
+
+static void cmd_replay(int argc, char **argv) {
+    if (passos_gravados == 0) {
+        printf("[REPLAY] Nenhuma partida gravada.\n");
+        return;
+    }
+    if (modo_gravado != MODO_UM_DRONE) {
+        printf("[REPLAY] So partidas com 1 drone podem ser reproduzidas.\n");
+        return;
+    }
+
+    printf("[REPLAY] Reproduzindo %d passos.\n", passos_gravados);
+    replay_pedido = true;
+    iniciar_jogo_no_laco();
+}
+
+// Roteiro de teste: semente e configuração fixas, uma entrada por passo
+// (w/a/s/d movem, r resgata, . fica parado) e os passos em que o framebuffer é
+// capturado. Roda pelo caminho do replay, com um drone, tanto na placa
+// (comando teste) quanto no teste de host (test/test_render.c).
+typedef struct {
+    uint32_t semente;
+    uint8_t vitimas;
+    uint8_t passo_drone;
+    const char *entradas;
+    uint16_t capturas[SNAPSHOT_MAX_GOLDEN];
+    uint8_t num_capturas;
+} roteiro_t;
+
+static const roteiro_t roteiro_teste = {
+    0xB17D06, MAX_VITIMAS, 4,
+    "wwwwr.ddddddwwwwwwr..aaaaaaaaaaaaaaaaaar.aasssssssr...",
+    { 0, 4, 12, 18, 39, 53 }, 6
+};
+
+static int limite_antes_roteiro;
+static modo_drones_t modo_antes_roteiro;
+
+// Carrega o roteiro como a partida gravada (substituindo a última gravação)
+// e inicia o jogo sem som. O timer mostra o número do passo.
+static void carregar_roteiro(const roteiro_t *r) {
+    passos_gravados = 0;
+    for (const char *c = r->entradas; *c && passos_gravados < MAX_GRAVACAO; c++) {
+        int dir_x = (*c == 'a') ? -1 : (*c == 'd') ? 1 : 0;
+        int dir_y = (*c == 'w') ? -1 : (*c == 's') ? 1 : 0;
+        gravacao[passos_gravados++] = codificar_passo(dir_x, dir_y, *c == 'r');
+    }
+    semente_gravada = r->semente;
+    vitimas_gravadas = r->vitimas;
+    passo_gravado = r->passo_drone;
+    passo_ms_gravado = passo_jogo_ms;
+    modo_gravado = MODO_UM_DRONE;
+
+    limite_antes_roteiro = limite_tempo;
+    modo_antes_roteiro = modo_drones;
+    limite_tempo = 999;
+    mudo = true;
+    replay_pedido = true;
+    iniciar_jogo();
+    tocar_som_inicio_flag = false;
+    dither_init(&dither, DITHER_BITS);
+    passo_jogo = 0;
+}
+
+// Roda um passo do roteiro como o laço principal, com um subquadro de
+// dithering, e retorna o tempo gasto
+static uint32_t passo_roteiro(int passo) {
+    uint32_t inicio = time_us_32();
+    executar_passo(passo);
+    guardar_fundo();
+    desenhar_subquadro();
+    dither_next(&dither);
+    passo_jogo++;
+    return time_us_32() - inicio;
+}
+
+// Encerra a partida do roteiro e devolve a configuração
+static void encerrar_roteiro() {
+    jogo_ativo = false;
+    reproduzindo = false;
+    for (int i = 0; i < MAX_VITIMAS; i++)
+        vitima_ativa[i] = false;
+    limite_tempo = limite_antes_roteiro;
+    modo_drones = modo_antes_roteiro;
+    mudo = false;
+    redesenhar_tela_inicial = true;
+}
+
+// Executa o roteiro na placa, com os botões mascarados. Ao gravar, guarda as
+// capturas na flash e as imprime em PBM; ao verificar, compara cada uma pixel
+// a pixel com a guardada. O tempo de cada passo sai na mesma execução.
+static void executar_roteiro(const roteiro_t *r, bool gravar) {
+    const snapshot_header_t *golden = snapshot_golden_header();
+    if (!gravar && (!golden || golden->seed != r->semente || golden->count != r->num_capturas ||
+                    golden->frame_size != snapshot_frame_size(&ssd) ||
+                    memcmp(golden->ticks, r->capturas, sizeof(golden->ticks)) != 0)) {
+        printf("[TESTE] Sem capturas de referencia para este roteiro; use 'teste gravar'.\n");
+        return;
+    }
+    if (gravar)
+        snapshot_golden_erase();
+
+    irq_set_enabled(IO_IRQ_BANK0, false);
+    carregar_roteiro(r);
+
+    int passos = passos_gravados;
+    int falhas = 0;
+    uint8_t captura = 0;
+    uint32_t total_us = 0, pior_us = 0;
+
+    for (int passo = 0; passo < passos; passo++) {
+        uint32_t passo_us = passo_roteiro(passo);
+        total_us += passo_us;
+        pior_us = MAX(pior_us, passo_us);
+
+        printf("[TESTE] passo %d: %lu us", passo, (unsigned long)passo_us);
+        if (captura < r->num_capturas && passo == r->capturas[captura]) {
+            uint8_t pagina, coluna;
+            if (gravar) {
+                if (!snapshot_golden_store(captura, &ssd)) {
+                    printf(", sem espaco na flash\n");
+                    falhas++;
+                } else {
+                    printf(", capturado\n");
+                    snapshot_print_pbm(&ssd);
+                }
+            } else if (snapshot_diff(snapshot_golden_frame(captura), ssd.ram_buffer + 1, ssd.pages, ssd.width, &pagina, &coluna)) {
+                falhas++;
+                printf(", DIFERENTE na pagina %u, coluna %u\n", pagina, coluna);
+                snapshot_print_pbm(&ssd);
+            } else {
+                printf(", igual\n");
+            }
+            captura++;
+        } else {
+            printf("\n");
+        }
+        ssd1306_send_data(&ssd);
+    }
+
+    encerrar_roteiro();
+    irq_set_enabled(IO_IRQ_BANK0, true);
+
+    // O cabeçalho só vale se todas as capturas foram gravadas
+    if (gravar && falhas == 0) {
+        snapshot_header_t header = { .magic = SNAPSHOT_MAGIC, .seed = r->semente,
+                                     .frame_size = snapshot_frame_size(&ssd), .count = r->num_capturas };
+        memcpy(header.ticks, r->capturas, sizeof(header.ticks));
+        snapshot_golden_finish(&header);
+    }
+    printf("[TESTE] %d passos, medio %lu us, pior %lu us, %d captura(s) diferente(s)\n", passos,
+           (unsigned long)(total_us / passos), (unsigned long)pior_us, falhas);
+}
+
+static void cmd_teste(int argc, char **argv) {
+    if (jogo_ativo) {
+        printf("[TESTE] Termine a partida antes de rodar o roteiro.\n");
+        return;
+    }
+    if (argc >= 2 && strcmp(argv[1], "gravar") == 0)
+        executar_roteiro(&roteiro_teste, true);
+    else if (argc >= 2 && strcmp(argv[1], "verificar") == 0)
+        executar_roteiro(&roteiro_teste, false);
+    else
+        printf("[CONSOLE] Uso: teste <gravar|verificar>\n");
+}
+
+static const console_command_t comandos[] = {
+    { "ajuda",      "lista os comandos",                   cmd_ajuda },
+    { "vitimas",    "<n> vitimas na proxima partida",      cmd_vitimas },
+    { "tempo",      "<s> limite de tempo",                 cmd_tempo },
+    { "velocidade", "<px> pixels por passo do drone",      cmd_velocidade },
+    { "fps",        "<n> passos do jogo por segundo",      cmd_fps },
+    { "clock",      "<id> perfil de desempenho",           cmd_clock },
+    { "fb",         "<hex|pbm> imprime o framebuffer",     cmd_fb },
+    { "captura",    "<iniciar|parar> profiling por passo", cmd_captura },
+    { "replay",     "reproduz a ultima partida",           cmd_replay },
+    { "teste",      "<gravar|verificar> teste de render",  cmd_teste },
+};
+
+// Registra os comandos no console lido pelo USB
+void iniciar_console() {
+    console_init(comandos, sizeof(comandos) / sizeof(comandos[0]));
+}
+
+// Sorteia vítimas e drones e libera o jogo para os dois cores
+void iniciar_jogo() {
+    jogo_ativo = false;
+    
+    // O replay repete a semente e a configuração da partida gravada, sempre
+    // com um drone; as outras partidas começam a gravar
+    reproduzindo = replay_pedido;
+    replay_pedido = false;
+    gravando = !reproduzindo;
+    resgate_gravado = false;
+    segundo_gravado = false;
+    if (reproduzindo) {
+        semente_partida = semente_gravada;
+        modo_drones = MODO_UM_DRONE;
+        passo_replay = 0;
+    } else {
+        semente_partida = semente_gravada = time_us_32();
+        vitimas_gravadas = num_vitimas;
+        passo_gravado = passo_drone;
+        passo_ms_gravado = passo_jogo_ms;
+        modo_gravado = modo_drones;
+        passos_gravados = 0;
+    }
+    
+    // O core 1 pode estar no meio de um passo da partida anterior: o novo
+    // estado é montado com a trava, e o contador de partida muda junto, para
+    // que uma reivindicação antiga seja recusada em vez de contar nesta
+    int x2, y2;
+    uint32_t irq = spin_lock_blocking(trava_vitimas);
+    total_resgatadas = 0;
+    resgatadas_por[0] = resgatadas_por[1] = 0;
+    vitimas_partida = vitimas_gravadas;
+    passo_partida = passo_gravado;
+    passo_ms_partida = passo_ms_gravado;
+    posicionar_vitimas();
+    posicionar_drone(&dronex, &droney);
+    posicionar_drone(&x2, &y2);
+    publicar_drone(0, dronex, droney);
+    publicar_drone(1, x2, y2);
+    drone2_inicio_x = x2;
+    drone2_inicio_y = y2;
+    __dmb();
+    partida++;
+    spin_unlock(trava_vitimas, irq);
+
+    // O planejamento da rota roda em fatias nos próximos quadros
+    planejador_iniciar(&plano, dronex, droney, posx, posy, vitimas_partida);
+    etapa_rota = 0;
+    quadros_plano = 0;
+    tempo_plano_us = 0;
+    jogo_ativo = true;
+    
+    gpio_put(RED, false);
+    gpio_put(GREEN, false);
+    
+    printf("[INICIO] Jogo iniciado.\n");
+    tocar_som_inicio_flag = true; 
+}
+
 // Atualiza o LED azul se o drone estiver sobre uma vítima
 void atualizar_led_azul() {
     bool sobre_vitima = false;
@@ -377,6 +1491,12 @@ void atualizar_matriz_led() {
     show_numbers(vitimas_restantes);
 }
 
+// Desliga todos os LEDs da matriz
+void apagar_matriz() {
+    for (uint i = 0; i < 25; i++)
+        put_pixel(0);
+}
+
 // Função para colocar um pixel na matriz de LEDs
 void put_pixel(uint32_t pixel_grb) {
     pio_sm_put_blocking(pio0, 0, pixel_grb << 8u);
@@ -410,6 +1530,7 @@ void show_numbers(uint number) {
 
 // Efeitos sonoros
 void beep(int freq, int duration_ms) {
+    if (mudo) return;
     int delay_us = 1000000 / (freq * 2);
     int cycles = (freq * duration_ms) / 1000;
     for (int i = 0; i < cycles; i++) {
@@ -0,0 +1,56 @@
+// Benchmark de host do planejador de rota do piloto automático, compilado
+// com PLANEJADOR_MAX_PONTOS=16 junto com os testes de host. A partir da raiz:
+//   cmake -S test -B build-test && cmake --build build-test
+//   build-test/bench_planejador
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "planejador.h"
+
+#define REPETICOES 5
+#define ORCAMENTO_QUADRO 256  // Mesmo orçamento por quadro usado no firmware
+
+static planejador_t plano;
+
+static double agora_us() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int main() {
+  int posx[PLANEJADOR_MAX_PONTOS], posy[PLANEJADOR_MAX_PONTOS];
+
+  srand(1234);
+  printf("vitimas  total_us  pior_quadro_us  quadros  custo\n");
+
+  for (int n = 5; n <= PLANEJADOR_MAX_PONTOS; n++) {
+    double total = 0, pior_quadro = 0;
+    int quadros = 0;
+
+    for (int r = 0; r < REPETICOES; r++) {
+      // Mesma faixa de posições que posicionar_vitimas()
+      for (int i = 0; i < n; i++) {
+        posx[i] = (rand() % (118 - 4 + 1)) + 4;
+        posy[i] = (rand() % (59 - 12 + 1)) + 8;
+      }
+
+      double inicio = agora_us();
+      planejador_iniciar(&plano, 64, 32, posx, posy, n);
+      quadros = 0;
+      bool pronto = false;
+      while (!pronto) {
+        double t0 = agora_us();
+        pronto = planejador_passo(&plano, ORCAMENTO_QUADRO);
+        double t = agora_us() - t0;
+        if (t > pior_quadro) pior_quadro = t;
+        quadros++;
+      }
+      total += agora_us() - inicio;
+    }
+
+    printf("%7d  %8.1f  %14.1f  %7d  %5u\n", n, total / REPETICOES, pior_quadro, quadros, plano.custo_total);
+  }
+  return 0;
+}
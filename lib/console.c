@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <string.h>
+#include "console.h"
+#include "pico/stdio_usb.h"
+#include "pico/stdio/driver.h"
+
+static const console_command_t *console_commands;
+static uint console_count;
+static char console_line[CONSOLE_MAX_LINE];
+static uint console_len;
+static volatile bool console_pending;
+
+// Chamado pelo driver USB quando chegam caracteres; só marca a pendência
+static void console_chars_available(void *param) {
+  console_pending = true;
+}
+
+void console_init(const console_command_t *commands, uint count) {
+  console_commands = commands;
+  console_count = count;
+  console_len = 0;
+  stdio_usb.set_chars_available_callback(console_chars_available, NULL);
+}
+
+void console_help() {
+  for (uint i = 0; i < console_count; ++i)
+    printf("  %-10s %s\n", console_commands[i].name, console_commands[i].help);
+}
+
+// Separa a linha em argumentos e chama o comando correspondente
+static void console_execute() {
+  char *argv[CONSOLE_MAX_ARGS];
+  int argc = 0;
+
+  for (char *tok = strtok(console_line, " \t"); tok && argc < CONSOLE_MAX_ARGS; tok = strtok(NULL, " \t"))
+    argv[argc++] = tok;
+  if (argc == 0)
+    return;
+
+  for (uint i = 0; i < console_count; ++i) {
+    if (strcmp(argv[0], console_commands[i].name) == 0) {
+      console_commands[i].handler(argc, argv);
+      return;
+    }
+  }
+  printf("[CONSOLE] Comando desconhecido: %s\n", argv[0]);
+}
+
+// Lê o que chegou pelo USB sem bloquear. Sem a marca de pendência do driver
+// retorna imediatamente, então o laço principal não paga nada sem entrada.
+void console_poll() {
+  if (!console_pending)
+    return;
+  console_pending = false;
+
+  char buf[16];
+  int n;
+  while ((n = stdio_usb.in_chars(buf, sizeof(buf))) > 0) {
+    for (int i = 0; i < n; ++i) {
+      char c = buf[i];
+      if (c == '\r' || c == '\n') {
+        console_line[console_len] = '\0';
+        console_execute();
+        console_len = 0;
+      } else if (console_len < CONSOLE_MAX_LINE - 1) {
+        console_line[console_len++] = c;
+      }
+    }
+  }
+}
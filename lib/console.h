@@ -0,0 +1,18 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+#define CONSOLE_MAX_LINE 64
+#define CONSOLE_MAX_ARGS 4
+
+typedef void (*console_handler_t)(int argc, char **argv);
+
+typedef struct {
+  const char *name;
+  const char *help;
+  console_handler_t handler;
+} console_command_t;
+
+void console_init(const console_command_t *commands, uint count);
+void console_poll();
+void console_help();
@@ -0,0 +1,54 @@
+#include "dither.h"
+
+void dither_init(dither_t *d, uint8_t bits) {
+  d->subframes = (1u << bits) - 1;
+  d->phase = 0;
+  d->count = 0;
+}
+
+void dither_clear(dither_t *d) {
+  d->count = 0;
+}
+
+bool dither_add(dither_t *d, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t level) {
+  if (d->count >= DITHER_MAX_SPRITES)
+    return false;
+
+  dither_sprite_t *s = &d->sprites[d->count++];
+  s->x = x;
+  s->y = y;
+  s->width = width;
+  s->height = height;
+  s->level = level > d->subframes ? d->subframes : level;
+  return true;
+}
+
+// Distribui os L subquadros acesos de forma uniforme no ciclo, como no
+// algoritmo de Bresenham, para que o pulso não vire um piscar lento
+static bool lit(uint8_t level, uint8_t phase, uint8_t subframes) {
+  return ((phase + 1) * level) / subframes != (phase * level) / subframes;
+}
+
+// Desenha o subquadro atual por cima do que já está no framebuffer. Pixels
+// vizinhos em xadrez usam fases opostas para espalhar o cintilar no espaço.
+void dither_draw(dither_t *d, ssd1306_t *ssd) {
+  for (uint8_t i = 0; i < d->count; ++i) {
+    const dither_sprite_t *s = &d->sprites[i];
+    for (uint8_t x = s->x; x < s->x + s->width; ++x) {
+      for (uint8_t y = s->y; y < s->y + s->height; ++y) {
+        uint8_t phase = (d->phase + ((x ^ y) & 1) * (d->subframes / 2 + 1)) % d->subframes;
+        ssd1306_pixel(ssd, x, y, lit(s->level, phase, d->subframes));
+      }
+    }
+  }
+}
+
+void dither_next(dither_t *d) {
+  if (++d->phase >= d->subframes)
+    d->phase = 0;
+}
+
+// Subquadros por segundo que o envio precisa sustentar
+uint32_t dither_required_rate(const dither_t *d) {
+  return d->subframes * DITHER_MIN_CYCLE_HZ;
+}
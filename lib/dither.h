@@ -0,0 +1,28 @@
+#pragma once
+
+#include "ssd1306.h"
+
+#define DITHER_MAX_SPRITES 16
+#define DITHER_MIN_CYCLE_HZ 20  // Ciclos de intensidade por segundo para não cintilar
+
+// Retângulo com intensidade de 0 a 2^bits - 1
+typedef struct {
+  uint8_t x, y, width, height;
+  uint8_t level;
+} dither_sprite_t;
+
+// Renderizador de dithering temporal: cada envio ao display é um subquadro
+// de 1 bit e um sprite de nível L fica aceso em L de cada 2^bits - 1 subquadros.
+typedef struct {
+  uint8_t subframes;
+  uint8_t phase;
+  uint8_t count;
+  dither_sprite_t sprites[DITHER_MAX_SPRITES];
+} dither_t;
+
+void dither_init(dither_t *d, uint8_t bits);
+void dither_clear(dither_t *d);
+bool dither_add(dither_t *d, uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t level);
+void dither_draw(dither_t *d, ssd1306_t *ssd);
+void dither_next(dither_t *d);
+uint32_t dither_required_rate(const dither_t *d);
@@ -0,0 +1,89 @@
+#include "planejador.h"
+
+#define CUSTO_INF 0xFFFF
+
+// O drone anda na horizontal e na vertical no mesmo quadro, então o custo
+// entre dois pontos é a distância de Chebyshev
+static uint16_t distancia(int x0, int y0, int x1, int y1) {
+  int dx = x0 > x1 ? x0 - x1 : x1 - x0;
+  int dy = y0 > y1 ? y0 - y1 : y1 - y0;
+  return (uint16_t)(dx > dy ? dx : dy);
+}
+
+void planejador_iniciar(planejador_t *p, int origem_x, int origem_y, const int *x, const int *y, uint8_t n) {
+  if (n > PLANEJADOR_MAX_PONTOS)
+    n = PLANEJADOR_MAX_PONTOS;
+
+  p->n = n;
+  p->mascara = 1;
+  p->pronto = n == 0;
+  p->custo_total = 0;
+
+  for (uint8_t i = 0; i < n; ++i) {
+    p->dist_origem[i] = distancia(origem_x, origem_y, x[i], y[i]);
+    for (uint8_t j = 0; j < n; ++j)
+      p->dist[i][j] = distancia(x[i], y[i], x[j], y[j]);
+  }
+}
+
+// Reconstrói a rota a partir do melhor último ponto da máscara completa
+static void reconstruir_rota(planejador_t *p) {
+  uint32_t mascara = (1u << p->n) - 1;
+  uint8_t ultimo = 0;
+
+  for (uint8_t j = 1; j < p->n; ++j)
+    if (p->custo[mascara][j] < p->custo[mascara][ultimo])
+      ultimo = j;
+  p->custo_total = p->custo[mascara][ultimo];
+
+  for (int k = p->n - 1; k >= 0; --k) {
+    p->rota[k] = ultimo;
+    uint8_t anterior = p->pai[mascara][ultimo];
+    mascara &= ~(1u << ultimo);
+    ultimo = anterior;
+  }
+}
+
+// Processa até `orcamento` máscaras (cada uma custa O(n^2)) e retorna se a
+// rota está pronta. As máscaras são visitadas em ordem crescente, então todo
+// subconjunto já foi resolvido quando é consultado e a tabela não precisa
+// ser inicializada de antemão.
+bool planejador_passo(planejador_t *p, uint32_t orcamento) {
+  const uint32_t fim = 1u << p->n;
+
+  while (!p->pronto && orcamento--) {
+    uint32_t mascara = p->mascara;
+
+    for (uint8_t j = 0; j < p->n; ++j) {
+      if (!(mascara & (1u << j)))
+        continue;
+
+      uint32_t resto = mascara & ~(1u << j);
+      if (!resto) {
+        p->custo[mascara][j] = p->dist_origem[j];
+        p->pai[mascara][j] = PLANEJADOR_SEM_PAI;
+        continue;
+      }
+
+      uint16_t melhor = CUSTO_INF;
+      uint8_t pai = PLANEJADOR_SEM_PAI;
+      for (uint8_t i = 0; i < p->n; ++i) {
+        if (!(resto & (1u << i)))
+          continue;
+        uint16_t c = p->custo[resto][i] + p->dist[i][j];
+        if (c < melhor) {
+          melhor = c;
+          pai = i;
+        }
+      }
+      p->custo[mascara][j] = melhor;
+      p->pai[mascara][j] = pai;
+    }
+
+    if (++p->mascara == fim) {
+      reconstruir_rota(p);
+      p->pronto = true;
+    }
+  }
+  return p->pronto;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Quantidade máxima de vítimas que o planejador aceita. A tabela ocupa
+// 3 * 2^N * N bytes, então o firmware usa um valor pequeno e o benchmark
+// de host redefine para 16.
+#ifndef PLANEJADOR_MAX_PONTOS
+#define PLANEJADOR_MAX_PONTOS 8
+#endif
+
+#define PLANEJADOR_SEM_PAI 0xFF
+
+// Planejador da ordem de visita das vítimas (caixeiro viajante sem retorno)
+// por programação dinâmica em bitmask, executado em fatias entre quadros.
+typedef struct {
+  uint8_t n;
+  bool pronto;
+  uint32_t mascara;                             // Próxima máscara a processar
+  uint16_t dist_origem[PLANEJADOR_MAX_PONTOS];
+  uint16_t dist[PLANEJADOR_MAX_PONTOS][PLANEJADOR_MAX_PONTOS];
+  uint16_t custo[1u << PLANEJADOR_MAX_PONTOS][PLANEJADOR_MAX_PONTOS];
+  uint8_t pai[1u << PLANEJADOR_MAX_PONTOS][PLANEJADOR_MAX_PONTOS];
+  uint8_t rota[PLANEJADOR_MAX_PONTOS];          // Índices das vítimas em ordem de visita
+  uint16_t custo_total;
+} planejador_t;
+
+void planejador_iniciar(planejador_t *p, int origem_x, int origem_y, const int *x, const int *y, uint8_t n);
+bool planejador_passo(planejador_t *p, uint32_t orcamento);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/sync.h"
+
+// Seqlock de escritor único: o contador fica ímpar enquanto o escritor
+// atualiza os dados e o leitor repete a cópia se ele mudou no meio.
+// O leitor nunca bloqueia o escritor.
+typedef struct {
+  volatile uint32_t seq;
+} seqlock_t;
+
+static inline void seqlock_escrita_inicio(seqlock_t *s) {
+  s->seq++;
+  __dmb();
+}
+
+static inline void seqlock_escrita_fim(seqlock_t *s) {
+  __dmb();
+  s->seq++;
+}
+
+static inline uint32_t seqlock_leitura_inicio(const seqlock_t *s) {
+  uint32_t seq;
+  while ((seq = s->seq) & 1u)
+    ;
+  __dmb();
+  return seq;
+}
+
+static inline bool seqlock_leitura_repetir(const seqlock_t *s, uint32_t seq) {
+  __dmb();
+  return s->seq != seq;
+}
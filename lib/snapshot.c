@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <string.h>
+#include "snapshot.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+
+// Dois setores: o cabeçalho na primeira página e as capturas em seguida,
+// cada uma começando em uma página
+#define GOLDEN_OFFSET (PICO_FLASH_SIZE_BYTES - 2 * FLASH_SECTOR_SIZE)
+#define GOLDEN_FRAMES_OFFSET (GOLDEN_OFFSET + FLASH_PAGE_SIZE)
+#define GOLDEN_FRAMES_SIZE (2 * FLASH_SECTOR_SIZE - FLASH_PAGE_SIZE)
+
+typedef struct {
+  uint32_t offset;
+  const uint8_t *data;
+  size_t size;
+} golden_write_t;
+
+// Bytes do framebuffer na ordem da RAM do display, uma coluna por linha
+void snapshot_print_hex(ssd1306_t *ssd) {
+  for (uint8_t x = 0; x < ssd->width; ++x) {
+    for (uint8_t p = 0; p < ssd->pages; ++p)
+      printf("%02x", ssd->ram_buffer[1 + x * ssd->pages + p]);
+    printf("\n");
+  }
+}
+
+// Imagem PBM em texto (P1), legível por qualquer visualizador
+void snapshot_write_pbm(FILE *f, ssd1306_t *ssd) {
+  fprintf(f, "P1\n%u %u\n", ssd->width, ssd->height);
+  for (uint8_t y = 0; y < ssd->height; ++y) {
+    for (uint8_t x = 0; x < ssd->width; ++x)
+      fputc(ssd1306_get_pixel(ssd, x, y) ? '1' : '0', f);
+    fputc('\n', f);
+  }
+}
+
+void snapshot_print_pbm(ssd1306_t *ssd) {
+  snapshot_write_pbm(stdout, ssd);
+}
+
+// Compara dois framebuffers (sem o byte de controle) pixel a pixel e devolve
+// a primeira página e coluna diferentes, varrendo página por página
+bool snapshot_diff(const uint8_t *expected, const uint8_t *actual, uint8_t pages, uint8_t width, uint8_t *page, uint8_t *column) {
+  for (uint8_t p = 0; p < pages; ++p) {
+    for (uint8_t x = 0; x < width; ++x) {
+      if (expected[x * pages + p] != actual[x * pages + p]) {
+        *page = p;
+        *column = x;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Bytes do framebuffer sem o byte de controle
+uint16_t snapshot_frame_size(const ssd1306_t *ssd) {
+  return ssd->pages * ssd->width;
+}
+
+static uint32_t golden_stride(uint16_t frame_size) {
+  return (frame_size + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE;
+}
+
+// Executado com o outro core parado e as interrupções desligadas
+static void golden_erase(void *param) {
+  flash_range_erase(GOLDEN_OFFSET, 2 * FLASH_SECTOR_SIZE);
+}
+
+static void golden_program(void *param) {
+  const golden_write_t *w = param;
+  flash_range_program(w->offset, w->data, w->size);
+}
+
+void snapshot_golden_erase() {
+  flash_safe_execute(golden_erase, NULL, UINT32_MAX);
+}
+
+// A flash só grava páginas inteiras: as completas saem direto do framebuffer
+// e o resto vai por uma página completada com 0xFF
+bool snapshot_golden_store(uint8_t index, ssd1306_t *ssd) {
+  static uint8_t page[FLASH_PAGE_SIZE];
+  uint16_t size = snapshot_frame_size(ssd);
+  uint32_t stride = golden_stride(size);
+  if (index >= SNAPSHOT_MAX_GOLDEN || (index + 1) * stride > GOLDEN_FRAMES_SIZE)
+    return false;
+
+  uint32_t offset = GOLDEN_FRAMES_OFFSET + index * stride;
+  uint32_t whole = size / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE;
+  if (whole) {
+    golden_write_t w = { offset, ssd->ram_buffer + 1, whole };
+    flash_safe_execute(golden_program, &w, UINT32_MAX);
+  }
+  if (size > whole) {
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, ssd->ram_buffer + 1 + whole, size - whole);
+    golden_write_t w = { offset + whole, page, sizeof(page) };
+    flash_safe_execute(golden_program, &w, UINT32_MAX);
+  }
+  return true;
+}
+
+// O cabeçalho é gravado por último, então capturas incompletas não valem
+void snapshot_golden_finish(const snapshot_header_t *header) {
+  static uint8_t page[FLASH_PAGE_SIZE];
+  memset(page, 0xFF, sizeof(page));
+  memcpy(page, header, sizeof(*header));
+
+  golden_write_t w = { GOLDEN_OFFSET, page, sizeof(page) };
+  flash_safe_execute(golden_program, &w, UINT32_MAX);
+}
+
+const snapshot_header_t *snapshot_golden_header() {
+  const snapshot_header_t *header = (const snapshot_header_t *)(XIP_BASE + GOLDEN_OFFSET);
+  return header->magic == SNAPSHOT_MAGIC ? header : NULL;
+}
+
+const uint8_t *snapshot_golden_frame(uint8_t index) {
+  const snapshot_header_t *header = snapshot_golden_header();
+  if (!header || index >= header->count)
+    return NULL;
+  return (const uint8_t *)(XIP_BASE + GOLDEN_FRAMES_OFFSET + index * golden_stride(header->frame_size));
+}
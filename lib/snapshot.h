@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdio.h>
+#include "ssd1306.h"
+
+// Capturas de referência guardadas nos últimos setores da flash, fora da
+// área gravada pelo UF2, para sobreviver à regravação do firmware
+// O tamanho de cada captura vem da geometria do painel e fica no cabeçalho
+#define SNAPSHOT_MAX_GOLDEN 6
+#define SNAPSHOT_MAGIC 0x534E5032u
+
+typedef struct {
+  uint32_t magic;
+  uint32_t seed;         // Identifica o roteiro que gerou as capturas
+  uint16_t ticks[SNAPSHOT_MAX_GOLDEN];
+  uint16_t frame_size;   // Bytes por captura (páginas x colunas)
+  uint8_t count;
+} snapshot_header_t;
+
+void snapshot_print_hex(ssd1306_t *ssd);
+void snapshot_print_pbm(ssd1306_t *ssd);
+void snapshot_write_pbm(FILE *f, ssd1306_t *ssd);
+bool snapshot_diff(const uint8_t *expected, const uint8_t *actual, uint8_t pages, uint8_t width, uint8_t *page, uint8_t *column);
+
+uint16_t snapshot_frame_size(const ssd1306_t *ssd);
+
+void snapshot_golden_erase();
+bool snapshot_golden_store(uint8_t index, ssd1306_t *ssd);
+void snapshot_golden_finish(const snapshot_header_t *header);
+const snapshot_header_t *snapshot_golden_header();
+const uint8_t *snapshot_golden_frame(uint8_t index);
@@ -1,43 +1,70 @@
+#include <string.h>
 #include "ssd1306.h"
 #include "font.h"
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+  ssd1306_init_controller(ssd, SSD1306_CONTROLLER, width, height, external_vcc, address, i2c);
+}
+
+void ssd1306_init_controller(ssd1306_t *ssd, ssd1306_controller_t controller, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+  ssd->controller = controller;
   ssd->width = width;
   ssd->height = height;
   ssd->pages = height / 8U;
   ssd->address = address;
   ssd->i2c_port = i2c;
+  ssd->external_vcc = external_vcc;
+  ssd->col_offset = controller == SH1106_CONTROLLER ? 2 : 0;
   ssd->bufsize = ssd->pages * ssd->width + 1;
   ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->dirty_x0 = 0;
+  ssd->dirty_x1 = width - 1;
+  ssd->flush_stage = 0xFF;
+  ssd->saved_ptr = NULL;
+
+  // O SH1106 só tem endereçamento por página, então cada página é montada
+  // a partir do buffer em colunas antes de ser enviada
+  ssd->page_buffer = NULL;
+  if (controller == SH1106_CONTROLLER) {
+    ssd->page_buffer = calloc(width + 1, sizeof(uint8_t));
+    ssd->page_buffer[0] = 0x40;
+  }
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
   ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
+  if (ssd->controller == SSD1306_CONTROLLER) {
+    ssd1306_command(ssd, SET_MEM_ADDR);
+    ssd1306_command(ssd, 0x01);
+  }
   ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
   ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
   ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
+  ssd1306_command(ssd, ssd->height - 1);
   ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
   ssd1306_command(ssd, SET_DISP_OFFSET);
   ssd1306_command(ssd, 0x00);
   ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
+  ssd1306_command(ssd, ssd->height == 32 ? 0x02 : 0x12);
   ssd1306_command(ssd, SET_DISP_CLK_DIV);
   ssd1306_command(ssd, 0x80);
   ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
+  ssd1306_command(ssd, ssd->external_vcc ? 0x22 : 0xF1);
   ssd1306_command(ssd, SET_VCOM_DESEL);
   ssd1306_command(ssd, 0x30);
   ssd1306_command(ssd, SET_CONTRAST);
   ssd1306_command(ssd, 0xFF);
   ssd1306_command(ssd, SET_ENTIRE_ON);
   ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
+  if (ssd->controller == SH1106_CONTROLLER) {
+    ssd1306_command(ssd, SET_DCDC);
+    ssd1306_command(ssd, ssd->external_vcc ? 0x8A : 0x8B);
+  } else {
+    ssd1306_command(ssd, SET_CHARGE_PUMP);
+    ssd1306_command(ssd, ssd->external_vcc ? 0x10 : 0x14);
+  }
   ssd1306_command(ssd, SET_DISP | 0x01);
 }
 
@@ -52,29 +79,225 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   );
 }
 
+// Começa o envio das colunas alteradas; o desenho feito durante o envio
+// volta a marcar colunas para o próximo
+static void ssd1306_flush_begin(ssd1306_t *ssd) {
+  ssd->flush_x0 = ssd->dirty_x0;
+  ssd->flush_x1 = ssd->dirty_x1;
+  ssd->flush_stage = ssd->dirty_x0 > ssd->dirty_x1 ? 0xFF : 0;
+  ssd->dirty_x0 = 0xFF;
+  ssd->dirty_x1 = 0;
+}
+
+// Devolve o prefixo emprestado do buffer na transferência anterior
+static void ssd1306_flush_restore(ssd1306_t *ssd) {
+  if (ssd->saved_ptr) {
+    *ssd->saved_ptr = ssd->saved_byte;
+    ssd->saved_ptr = NULL;
+  }
+}
+
+// Interrompe o envio e marca de novo as colunas que não chegaram ao painel
+static void ssd1306_flush_cancel(ssd1306_t *ssd) {
+  ssd1306_flush_restore(ssd);
+  if (ssd->flush_stage != 0xFF) {
+    if (ssd->dirty_x0 > ssd->dirty_x1) {
+      ssd->dirty_x0 = ssd->flush_x0;
+      ssd->dirty_x1 = ssd->flush_x1;
+    } else {
+      ssd->dirty_x0 = MIN(ssd->dirty_x0, ssd->flush_x0);
+      ssd->dirty_x1 = MAX(ssd->dirty_x1, ssd->flush_x1);
+    }
+  }
+  ssd->flush_stage = 0xFF;
+}
+
+// Gera a próxima transação I2C do envio em andamento e retorna false ao
+// terminar. No SSD1306 (endereçamento vertical) as colunas alteradas ocupam
+// um trecho contíguo do buffer e o byte anterior é trocado pelo prefixo de
+// dados; no SH1106 cada página vai em uma transação própria.
+static bool ssd1306_flush_next(ssd1306_t *ssd, const uint8_t **buf, size_t *len) {
+  ssd1306_flush_restore(ssd);
+  if (ssd->flush_stage == 0xFF)
+    return false;
+
+  uint8_t x0 = ssd->flush_x0, x1 = ssd->flush_x1;
+  uint8_t stage = ssd->flush_stage++;
+
+  if (ssd->controller == SSD1306_CONTROLLER) {
+    if (stage == 0) {
+      const uint8_t cmd[] = { 0x00, SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, 0, ssd->pages - 1 };
+      memcpy(ssd->cmd_buffer, cmd, sizeof(cmd));
+      *buf = ssd->cmd_buffer;
+      *len = sizeof(cmd);
+      return true;
+    }
+    if (stage == 1) {
+      uint8_t *inicio = ssd->ram_buffer + x0 * ssd->pages;
+      ssd->saved_ptr = inicio;
+      ssd->saved_byte = *inicio;
+      *inicio = 0x40;
+      *buf = inicio;
+      *len = (x1 - x0 + 1) * ssd->pages + 1;
+      return true;
+    }
+  } else if (stage < 2 * ssd->pages) {
+    uint8_t page = stage / 2;
+    uint8_t col = x0 + ssd->col_offset;
+    if (stage % 2 == 0) {
+      const uint8_t cmd[] = { 0x00, SET_PAGE_START | page, SET_LOW_COL | (col & 0x0F), SET_HIGH_COL | (col >> 4) };
+      memcpy(ssd->cmd_buffer, cmd, sizeof(cmd));
+      *buf = ssd->cmd_buffer;
+      *len = sizeof(cmd);
+    } else {
+      for (uint8_t x = x0; x <= x1; ++x)
+        ssd->page_buffer[1 + x - x0] = ssd->ram_buffer[1 + x * ssd->pages + page];
+      *buf = ssd->page_buffer;
+      *len = x1 - x0 + 2;
+    }
+    return true;
+  }
+
+  ssd->flush_stage = 0xFF;
+  return false;
+}
+
 void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
-  );
+  ssd->dirty_x0 = 0;
+  ssd->dirty_x1 = ssd->width - 1;
+  ssd1306_send_dirty(ssd);
+}
+
+// Envia apenas as colunas alteradas
+void ssd1306_send_dirty(ssd1306_t *ssd) {
+  const uint8_t *buf;
+  size_t len;
+
+  ssd1306_flush_begin(ssd);
+  while (ssd1306_flush_next(ssd, &buf, &len))
+    i2c_write_blocking(ssd->i2c_port, ssd->address, buf, len, false);
+}
+
+// Canal do escalonador: um por controlador I2C
+typedef struct {
+  i2c_inst_t *port;
+  ssd1306_t *panel;
+  uint next;           // Próximo índice da lista de painéis a verificar
+  const uint8_t *buf;
+  size_t len, pos;
+  bool active;
+} ssd1306_channel_t;
+
+// Inicia uma transação escrevendo o endereço do painel no controlador
+static void ssd1306_channel_start(ssd1306_channel_t *ch) {
+  i2c_hw_t *hw = i2c_get_hw(ch->port);
+  hw->enable = 0;
+  hw->tar = ch->panel->address;
+  hw->enable = 1;
+  (void)hw->clr_stop_det;
+  ch->pos = 0;
+  ch->active = true;
+}
+
+// Alimenta a FIFO do canal sem esperar; retorna true quando a transação termina
+static bool ssd1306_channel_feed(ssd1306_channel_t *ch) {
+  i2c_hw_t *hw = i2c_get_hw(ch->port);
+
+  if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+    (void)hw->clr_tx_abrt;
+    (void)hw->clr_stop_det;
+    ssd1306_flush_cancel(ch->panel);
+    ch->panel = NULL;
+    return true;
+  }
+
+  while (ch->pos < ch->len && i2c_get_write_available(ch->port)) {
+    bool last = ch->pos == ch->len - 1;
+    hw->data_cmd = ch->buf[ch->pos++] | (last ? I2C_IC_DATA_CMD_STOP_BITS : 0);
+  }
+
+  if (ch->pos == ch->len && (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS)) {
+    (void)hw->clr_stop_det;
+    return true;
+  }
+  return false;
+}
+
+// Envia as colunas alteradas de vários painéis. Cada controlador I2C tem seu
+// canal e a CPU alterna entre as FIFOs, então painéis em barramentos
+// diferentes transferem ao mesmo tempo; no mesmo barramento vão em sequência.
+// Retorna false se nenhum painel tinha colunas alteradas.
+bool ssd1306_flush(ssd1306_t *const *panels, uint count) {
+  ssd1306_channel_t channels[2] = {
+    { .port = i2c0 },
+    { .port = i2c1 },
+  };
+
+  for (uint i = 0; i < count; ++i)
+    ssd1306_flush_begin(panels[i]);
+
+  bool sent = false;
+  bool busy = true;
+  while (busy) {
+    busy = false;
+    for (uint c = 0; c < 2; ++c) {
+      ssd1306_channel_t *ch = &channels[c];
+
+      if (ch->active) {
+        if (ssd1306_channel_feed(ch))
+          ch->active = false;
+        else {
+          busy = true;
+          continue;
+        }
+      }
+
+      // Próxima transação do painel atual ou do próximo painel deste barramento
+      while (!ch->active) {
+        if (ch->panel && ssd1306_flush_next(ch->panel, &ch->buf, &ch->len)) {
+          ssd1306_channel_start(ch);
+          sent = true;
+          break;
+        }
+        ch->panel = NULL;
+        while (ch->next < count && panels[ch->next]->i2c_port != ch->port)
+          ch->next++;
+        if (ch->next == count)
+          break;
+        ch->panel = panels[ch->next++];
+      }
+      busy |= ch->active;
+    }
+  }
+  return sent;
+}
+
+static inline bool ssd1306_inside(ssd1306_t *ssd, uint8_t x, uint8_t y) {
+  return x < ssd->width && y < ssd->height;
 }
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
-  uint16_t index = (y >> 3) + (x << 3) + 1;
+  if (!ssd1306_inside(ssd, x, y))
+    return;
+  uint16_t index = (y >> 3) + x * ssd->pages + 1;
   uint8_t pixel = (y & 0b111);
-  if (value)
-    ssd->ram_buffer[index] |= (1 << pixel);
-  else
-    ssd->ram_buffer[index] &= ~(1 << pixel);
+  uint8_t byte = value ? ssd->ram_buffer[index] | (1 << pixel) : ssd->ram_buffer[index] & ~(1 << pixel);
+
+  // Redesenhar um pixel com o mesmo valor não suja a coluna
+  if (byte == ssd->ram_buffer[index])
+    return;
+  ssd->ram_buffer[index] = byte;
+  if (x < ssd->dirty_x0)
+    ssd->dirty_x0 = x;
+  if (x > ssd->dirty_x1)
+    ssd->dirty_x1 = x;
+}
+
+bool ssd1306_get_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y) {
+  if (!ssd1306_inside(ssd, x, y))
+    return false;
+  uint16_t index = (y >> 3) + x * ssd->pages + 1;
+  return ssd->ram_buffer[index] & (1 << (y & 0b111));
 }
 
 /*
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
@@ -22,24 +24,48 @@ typedef enum {
   SET_DISP_CLK_DIV = 0xD5,
   SET_PRECHARGE = 0xD9,
   SET_VCOM_DESEL = 0xDB,
-  SET_CHARGE_PUMP = 0x8D
+  SET_CHARGE_PUMP = 0x8D,
+  // Comandos exclusivos do SH1106
+  SET_LOW_COL = 0x00,
+  SET_HIGH_COL = 0x10,
+  SET_PAGE_START = 0xB0,
+  SET_DCDC = 0xAD
 } ssd1306_command_t;
 
+typedef enum {
+  SSD1306_CONTROLLER,
+  SH1106_CONTROLLER  // RAM de 132 colunas, apenas endereçamento por página
+} ssd1306_controller_t;
+
 typedef struct {
+  ssd1306_controller_t controller;
   uint8_t width, height, pages, address;
+  uint8_t col_offset;
   i2c_inst_t *i2c_port;
   bool external_vcc;
   uint8_t *ram_buffer;
   size_t bufsize;
   uint8_t port_buffer[2];
+  uint8_t dirty_x0, dirty_x1; // Colunas alteradas desde o último envio (x0 > x1 quando limpo)
+
+  // Envio em andamento
+  uint8_t flush_x0, flush_x1, flush_stage;
+  uint8_t cmd_buffer[8];
+  uint8_t *page_buffer;
+  uint8_t *saved_ptr;
+  uint8_t saved_byte;
 } ssd1306_t;
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
+void ssd1306_init_controller(ssd1306_t *ssd, ssd1306_controller_t controller, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_send_dirty(ssd1306_t *ssd);
+bool ssd1306_flush(ssd1306_t *const *panels, uint count);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
+bool ssd1306_get_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill);
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value);
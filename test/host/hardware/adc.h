@@ -0,0 +1,9 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+// Joystick sempre no centro
+static inline void adc_init(void) {}
+static inline void adc_gpio_init(uint gpio) {}
+static inline void adc_select_input(uint input) {}
+static inline uint16_t adc_read(void) { return 2048; }
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+enum clock_index { clk_gpout0, clk_gpout1, clk_gpout2, clk_gpout3, clk_ref, clk_sys, clk_peri, clk_usb, clk_adc, clk_rtc };
+
+typedef struct {
+  volatile uint32_t sleep_en0, sleep_en1;
+} clocks_hw_t;
+
+extern clocks_hw_t clocks_host;
+#define clocks_hw (&clocks_host)
+
+#define CLOCKS_SLEEP_EN0_CLK_SYS_IO_BITS 0x00008000u
+#define CLOCKS_SLEEP_EN0_CLK_SYS_PADS_BITS 0x00010000u
+#define CLOCKS_SLEEP_EN0_CLK_SYS_BUSFABRIC_BITS 0x00000020u
+#define CLOCKS_SLEEP_EN0_CLK_SYS_PLL_SYS_BITS 0x00040000u
+#define CLOCKS_SLEEP_EN1_CLK_SYS_XIP_BITS 0x00004000u
+
+static inline uint32_t clock_get_hz(enum clock_index clk) { return 125000000u; }
+static inline bool set_sys_clock_khz(uint32_t freq_khz, bool required) { return true; }
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#define PICO_FLASH_SIZE_BYTES (2u * 1024 * 1024)
+
+// Flash simulada em RAM, apagada com 0xFF como a real
+extern uint8_t flash_host[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)flash_host)
+
+void flash_range_erase(uint32_t offset, size_t count);
+void flash_range_program(uint32_t offset, const uint8_t *data, size_t count);
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+#define PICO_ERROR_GENERIC -1
+
+// Registradores do controlador I2C que o driver do display usa. As escritas em
+// data_cmd são recolhidas para a FIFO simulada a cada chamada de
+// i2c_get_hw/i2c_get_write_available, e cada i2c_get_hw transmite alguns bytes,
+// então os dois controladores avançam intercalados como na placa.
+typedef struct {
+  volatile uint32_t enable, tar, data_cmd, raw_intr_stat, clr_tx_abrt, clr_stop_det;
+} i2c_hw_t;
+
+#define I2C_HOST_FIFO 16
+
+typedef struct i2c_inst {
+  i2c_hw_t hw;
+
+  // Estado simulado: FIFO com o endereço de cada byte e a transação em curso
+  uint32_t fifo[I2C_HOST_FIFO];
+  uint8_t fifo_n;
+  bool em_transacao;
+  uint8_t endereco;
+  uint8_t transacao[2048];
+  size_t tamanho;
+} i2c_inst_t;
+
+extern i2c_inst_t i2c0_inst, i2c1_inst;
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040u
+#define I2C_IC_RAW_INTR_STAT_STOP_DET_BITS 0x00000200u
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200u
+
+static inline uint i2c_init(i2c_inst_t *i2c, uint baudrate) { return baudrate; }
+static inline uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate) { return baudrate; }
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us);
+size_t i2c_get_write_available(i2c_inst_t *i2c);
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c);
+
+// Painel simulado em um endereço do barramento: interpreta os comandos do
+// SSD1306 ou do SH1106 e guarda a GDDRAM (8 páginas de até 132 colunas)
+typedef struct {
+  bool sh1106;
+  uint8_t ram[8][132];
+  uint8_t modo, coluna, pagina;
+  uint8_t col_inicio, col_fim, pag_inicio, pag_fim;
+  uint8_t mux, com_pins;
+  bool ligado;
+  bool falhar;  // O próximo envio pela FIFO recebe NACK no endereço
+  uint32_t transacoes, bytes_dados, comandos_invalidos;
+
+  // Comando à espera dos argumentos
+  uint8_t comando, faltam, recebidos, argumentos[2];
+} i2c_host_painel_t;
+
+// Bytes transmitidos em um barramento enquanto o outro estava no meio de uma transação
+extern uint32_t i2c_host_simultaneos;
+
+void i2c_host_reiniciar(void);
+i2c_host_painel_t *i2c_host_conectar(i2c_inst_t *i2c, uint8_t endereco, bool sh1106);
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+#define IO_IRQ_BANK0 13
+
+static inline void irq_set_enabled(uint num, bool enabled) {}
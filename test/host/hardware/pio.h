@@ -0,0 +1,35 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+// A matriz de LEDs some: a state machine aceita e descarta os pixels
+typedef struct pio_hw pio_hw_t;
+typedef pio_hw_t *PIO;
+#define pio0 ((PIO)0)
+#define PIO_FIFO_JOIN_TX 1
+
+struct pio_program {
+  const uint16_t *instructions;
+  uint8_t length;
+  int8_t origin;
+  uint8_t pio_version;
+};
+
+typedef struct {
+  uint32_t clkdiv;
+} pio_sm_config;
+
+static inline uint pio_add_program(PIO pio, const struct pio_program *program) { return 0; }
+static inline pio_sm_config pio_get_default_sm_config(void) { return (pio_sm_config){ 0 }; }
+static inline void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap) {}
+static inline void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs) {}
+static inline void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base) {}
+static inline void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold) {}
+static inline void sm_config_set_fifo_join(pio_sm_config *c, int join) {}
+static inline void sm_config_set_clkdiv(pio_sm_config *c, float div) {}
+static inline void pio_gpio_init(PIO pio, uint pin) {}
+static inline void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin, uint count, bool is_out) {}
+static inline void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config) {}
+static inline void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {}
+static inline void pio_sm_set_clkdiv(PIO pio, uint sm, float div) {}
+static inline void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+typedef struct {
+  volatile uint32_t scr;
+} armv6m_scb_hw_t;
+
+extern armv6m_scb_hw_t scb_host;
+#define scb_hw (&scb_host)
+
+#define M0PLUS_SCR_SLEEPDEEP_BITS 0x00000004u
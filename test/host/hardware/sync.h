@@ -0,0 +1,20 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+// Um único core no host: as travas só precisam existir
+typedef volatile uint32_t spin_lock_t;
+
+static inline void __dmb(void) { __asm volatile("" ::: "memory"); }
+static inline void __wfi(void) {}
+static inline void __wfe(void) {}
+static inline void __sev(void) {}
+
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) {}
+
+extern spin_lock_t spin_lock_host;
+static inline int spin_lock_claim_unused(bool required) { return 0; }
+static inline spin_lock_t *spin_lock_instance(uint lock_num) { return &spin_lock_host; }
+static inline uint32_t spin_lock_blocking(spin_lock_t *lock) { return 0; }
+static inline void spin_unlock(spin_lock_t *lock, uint32_t saved_irq) {}
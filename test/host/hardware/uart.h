@@ -0,0 +1,13 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+typedef struct uart_inst uart_inst_t;
+#define uart0 ((uart_inst_t *)0)
+#define uart_default uart0
+#define PICO_DEFAULT_UART_BAUD_RATE 115200
+
+static inline bool uart_is_readable(uart_inst_t *uart) { return false; }
+static inline char uart_getc(uart_inst_t *uart) { return 0; }
+static inline uint uart_set_baudrate(uart_inst_t *uart, uint baudrate) { return baudrate; }
+static inline void uart_default_tx_wait_blocking(void) {}
@@ -0,0 +1,9 @@
+#pragma once
+
+enum vreg_voltage {
+  VREG_VOLTAGE_1_10 = 0b1011,
+  VREG_VOLTAGE_1_20 = 0b1101,
+  VREG_VOLTAGE_DEFAULT = VREG_VOLTAGE_1_10,
+};
+
+static inline void vreg_set_voltage(enum vreg_voltage voltage) {}
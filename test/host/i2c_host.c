@@ -0,0 +1,243 @@
+#include <string.h>
+#include "hardware/i2c.h"
+
+// Barramentos I2C simulados com painéis SSD1306/SH1106 que guardam a GDDRAM,
+// para o teste reconstruir o que cada display recebeu
+
+#define I2C_HOST_VAZIO 0x80000000u   // data_cmd já recolhido para a FIFO
+#define I2C_HOST_POR_CONSULTA 4      // Bytes que saem da FIFO a cada i2c_get_hw
+#define I2C_HOST_MAX_PAINEIS 4
+
+i2c_inst_t i2c0_inst = { .hw.data_cmd = I2C_HOST_VAZIO };
+i2c_inst_t i2c1_inst = { .hw.data_cmd = I2C_HOST_VAZIO };
+uint32_t i2c_host_simultaneos;
+
+typedef struct {
+  i2c_inst_t *porta;
+  uint8_t endereco;
+  i2c_host_painel_t painel;
+} conexao_t;
+
+static conexao_t conexoes[I2C_HOST_MAX_PAINEIS];
+static uint num_conexoes;
+
+void i2c_host_reiniciar(void) {
+  i2c_inst_t *portas[] = { i2c0, i2c1 };
+  for (uint i = 0; i < 2; ++i) {
+    memset(portas[i], 0, sizeof(i2c_inst_t));
+    portas[i]->hw.data_cmd = I2C_HOST_VAZIO;
+  }
+  num_conexoes = 0;
+  i2c_host_simultaneos = 0;
+}
+
+// Painel recém-ligado: RAM com lixo e o estado de reset do controlador
+i2c_host_painel_t *i2c_host_conectar(i2c_inst_t *i2c, uint8_t endereco, bool sh1106) {
+  if (num_conexoes == I2C_HOST_MAX_PAINEIS)
+    return NULL;
+  conexao_t *c = &conexoes[num_conexoes++];
+  c->porta = i2c;
+  c->endereco = endereco;
+
+  i2c_host_painel_t *p = &c->painel;
+  memset(p, 0, sizeof(*p));
+  memset(p->ram, 0xA5, sizeof(p->ram));
+  p->sh1106 = sh1106;
+  p->modo = 2;  // Endereçamento por página
+  p->col_fim = 127;
+  p->pag_fim = 7;
+  p->mux = 63;
+  p->com_pins = 0x12;
+  return p;
+}
+
+static i2c_host_painel_t *painel_em(i2c_inst_t *i2c, uint8_t endereco) {
+  for (uint i = 0; i < num_conexoes; ++i)
+    if (conexoes[i].porta == i2c && conexoes[i].endereco == endereco)
+      return &conexoes[i].painel;
+  return NULL;
+}
+
+// Quantos argumentos seguem o comando; -1 para um comando que o controlador não tem
+static int argumentos_do_comando(const i2c_host_painel_t *p, uint8_t c) {
+  switch (c) {
+    case 0x81: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+      return 1;
+    case 0x20: case 0x8D:
+      return p->sh1106 ? -1 : 1;
+    case 0x21: case 0x22:
+      return p->sh1106 ? -1 : 2;
+    case 0xAD:
+      return p->sh1106 ? 1 : -1;
+  }
+  if (c >= 0xB0 && c <= 0xB7)
+    return 0;
+  if (c < 0x20 || (c >= 0x40 && c <= 0x7F) || (c >= 0xA0 && c <= 0xAF) || c == 0xC0 || c == 0xC8)
+    return 0;
+  return -1;
+}
+
+static void executar_comando(i2c_host_painel_t *p) {
+  uint8_t c = p->comando;
+  const uint8_t *a = p->argumentos;
+
+  if (c <= 0x0F)
+    p->coluna = (p->coluna & 0xF0) | c;
+  else if (c <= 0x1F)
+    p->coluna = (p->coluna & 0x0F) | (c & 0x0F) << 4;
+  else if (c >= 0xB0 && c <= 0xB7)
+    p->pagina = c & 0x07;
+  else if (c == 0x20)
+    p->modo = a[0] & 0x03;
+  else if (c == 0x21) {
+    p->col_inicio = p->coluna = a[0] & 0x7F;
+    p->col_fim = a[1] & 0x7F;
+  } else if (c == 0x22) {
+    p->pag_inicio = p->pagina = a[0] & 0x07;
+    p->pag_fim = a[1] & 0x07;
+  } else if (c == 0xA8)
+    p->mux = a[0];
+  else if (c == 0xDA)
+    p->com_pins = a[0];
+  else if (c == 0xAE || c == 0xAF)
+    p->ligado = c & 1;
+}
+
+// Os argumentos podem chegar em transações separadas (um comando por vez)
+static void receber_comando(i2c_host_painel_t *p, uint8_t byte) {
+  if (p->faltam) {
+    p->argumentos[p->recebidos++] = byte;
+    if (--p->faltam == 0)
+      executar_comando(p);
+    return;
+  }
+
+  int n = argumentos_do_comando(p, byte);
+  if (n < 0) {
+    p->comandos_invalidos++;
+    return;
+  }
+  p->comando = byte;
+  p->faltam = n;
+  p->recebidos = 0;
+  if (n == 0)
+    executar_comando(p);
+}
+
+// Escreve na GDDRAM e avança o ponteiro como o modo de endereçamento manda.
+// O SH1106 só tem o modo por página, com 132 colunas.
+static void receber_dado(i2c_host_painel_t *p, uint8_t byte) {
+  uint8_t ultima_coluna = p->sh1106 ? 131 : 127;
+  if (p->pagina < 8 && p->coluna <= ultima_coluna)
+    p->ram[p->pagina][p->coluna] = byte;
+  p->bytes_dados++;
+
+  if (p->sh1106 || p->modo == 2) {
+    if (p->coluna < ultima_coluna)
+      p->coluna++;
+  } else if (p->modo == 1) {
+    if (p->pagina < p->pag_fim)
+      p->pagina++;
+    else {
+      p->pagina = p->pag_inicio;
+      p->coluna = p->coluna < p->col_fim ? p->coluna + 1 : p->col_inicio;
+    }
+  } else {
+    if (p->coluna < p->col_fim)
+      p->coluna++;
+    else {
+      p->coluna = p->col_inicio;
+      p->pagina = p->pagina < p->pag_fim ? p->pagina + 1 : p->pag_inicio;
+    }
+  }
+}
+
+// Uma transação completa: bytes de controle (Co, D/C) seguidos de comandos ou dados
+static void entregar(i2c_host_painel_t *p, const uint8_t *buf, size_t len) {
+  p->transacoes++;
+  size_t i = 0;
+  while (i < len) {
+    uint8_t controle = buf[i++];
+    bool dados = controle & 0x40;
+    size_t fim = (controle & 0x80) ? MIN(i + 1, len) : len;
+    for (; i < fim; ++i) {
+      if (dados)
+        receber_dado(p, buf[i]);
+      else
+        receber_comando(p, buf[i]);
+    }
+  }
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+  i2c_host_painel_t *p = painel_em(i2c, addr);
+  if (!p)
+    return PICO_ERROR_GENERIC;
+  entregar(p, src, len);
+  return len;
+}
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us) {
+  return i2c_write_blocking(i2c, addr, src, len, nostop);
+}
+
+// Move para a FIFO o último byte escrito em data_cmd, com o endereço atual
+static void recolher(i2c_inst_t *i2c) {
+  if (i2c->hw.data_cmd == I2C_HOST_VAZIO)
+    return;
+  if (i2c->fifo_n < I2C_HOST_FIFO)
+    i2c->fifo[i2c->fifo_n++] = (i2c->hw.tar << 16) | (i2c->hw.data_cmd & 0x3FF);
+  i2c->hw.data_cmd = I2C_HOST_VAZIO;
+}
+
+// Transmite um byte da FIFO. Um endereço sem painel, ou com falha pedida,
+// recebe NACK: a transação é abortada e a FIFO descartada.
+static void transmitir(i2c_inst_t *i2c) {
+  uint32_t item = i2c->fifo[0];
+  i2c->fifo_n--;
+  memmove(i2c->fifo, i2c->fifo + 1, i2c->fifo_n * sizeof(i2c->fifo[0]));
+
+  if (!i2c->em_transacao) {
+    i2c->endereco = item >> 16;
+    i2c_host_painel_t *p = painel_em(i2c, i2c->endereco);
+    if (!p || p->falhar) {
+      if (p)
+        p->falhar = false;
+      i2c->fifo_n = 0;
+      i2c->hw.raw_intr_stat |= I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS;
+      return;
+    }
+    i2c->em_transacao = true;
+    i2c->tamanho = 0;
+  }
+
+  i2c_inst_t *outro = i2c == i2c0 ? i2c1 : i2c0;
+  if (outro->em_transacao)
+    i2c_host_simultaneos++;
+
+  if (i2c->tamanho < sizeof(i2c->transacao))
+    i2c->transacao[i2c->tamanho++] = item & 0xFF;
+  if (item & I2C_IC_DATA_CMD_STOP_BITS) {
+    entregar(painel_em(i2c, i2c->endereco), i2c->transacao, i2c->tamanho);
+    i2c->em_transacao = false;
+    i2c->hw.raw_intr_stat |= I2C_IC_RAW_INTR_STAT_STOP_DET_BITS;
+  }
+}
+
+size_t i2c_get_write_available(i2c_inst_t *i2c) {
+  recolher(i2c);
+  return I2C_HOST_FIFO - i2c->fifo_n;
+}
+
+// Os eventos ficam visíveis até a próxima consulta, quando o driver já leu os
+// registradores clr_*; depois alguns bytes saem da FIFO
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) {
+  recolher(i2c);
+  i2c->hw.raw_intr_stat = 0;
+  for (int i = 0; i < I2C_HOST_POR_CONSULTA && i2c->fifo_n; ++i) {
+    transmitir(i2c);
+    if (i2c->hw.raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+      break;
+  }
+  return &i2c->hw;
+}
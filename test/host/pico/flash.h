@@ -0,0 +1,12 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+#define PICO_OK 0
+
+// Sem o outro core para parar, a função roda direto
+static inline int flash_safe_execute(void (*func)(void *), void *param, uint32_t timeout_ms) {
+  func(param);
+  return PICO_OK;
+}
+static inline bool flash_safe_execute_core_init(void) { return true; }
@@ -0,0 +1,8 @@
+#pragma once
+
+typedef struct stdio_driver {
+  int (*in_chars)(char *buf, int len);
+  void (*set_chars_available_callback)(void (*fn)(void *), void *param);
+} stdio_driver_t;
+
+extern stdio_driver_t stdio_usb;
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+static inline bool stdio_usb_connected(void) { return false; }
@@ -0,0 +1,50 @@
+#pragma once
+
+// Substitutos de host do Pico SDK, só com o que o jogo usa. O hardware não
+// existe: GPIO, ADC, PIO e sons viram operações vazias e o tempo não passa
+// nas esperas, para o teste rodar em milissegundos.
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+#define GPIO_IRQ_EDGE_FALL 0x4u
+#define GPIO_FUNC_I2C 3
+
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event);
+
+static inline void stdio_init_all(void) {}
+static inline void gpio_init(uint gpio) {}
+static inline void gpio_set_dir(uint gpio, bool out) {}
+static inline void gpio_pull_up(uint gpio) {}
+static inline void gpio_put(uint gpio, bool value) {}
+static inline bool gpio_get(uint gpio) { return true; }  // Botões soltos (pull-up)
+static inline void gpio_set_function(uint gpio, int fn) {}
+static inline void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t cb) {}
+
+static inline uint64_t time_us_64(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000u;
+}
+static inline uint32_t time_us_32(void) { return (uint32_t)time_us_64(); }
+static inline absolute_time_t get_absolute_time(void) { return time_us_64(); }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return (int64_t)(to - from); }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return time_us_64() + ms * 1000ull; }
+static inline bool time_reached(absolute_time_t t) { return time_us_64() >= t; }
+static inline void sleep_ms(uint32_t ms) {}
+static inline void sleep_until(absolute_time_t t) {}
+static inline void sleep_us(uint64_t us) {}
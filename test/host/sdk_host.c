@@ -0,0 +1,33 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/stdio/driver.h"
+#include "hardware/sync.h"
+#include "hardware/clocks.h"
+#include "hardware/flash.h"
+#include "hardware/structs/scb.h"
+
+// Estado dos periféricos simulados (o I2C fica em i2c_host.c)
+
+spin_lock_t spin_lock_host;
+clocks_hw_t clocks_host;
+armv6m_scb_hw_t scb_host;
+uint8_t flash_host[PICO_FLASH_SIZE_BYTES];
+
+// Sem host USB: nunca chegam caracteres
+static int usb_in_chars(char *buf, int len) {
+  return 0;
+}
+
+static void usb_set_chars_available_callback(void (*fn)(void *), void *param) {}
+
+stdio_driver_t stdio_usb = { usb_in_chars, usb_set_chars_available_callback };
+
+void flash_range_erase(uint32_t offset, size_t count) {
+  memset(flash_host + offset, 0xFF, count);
+}
+
+// Como na flash real, gravar só consegue levar bits de 1 para 0
+void flash_range_program(uint32_t offset, const uint8_t *data, size_t count) {
+  for (size_t i = 0; i < count; ++i)
+    flash_host[offset + i] &= data[i];
+}
@@ -0,0 +1,171 @@
+// Teste de host do envio aos displays: configura painéis SSD1306 128x64,
+// SSD1306 128x32 e SH1106 no barramento simulado de test/host, em um só
+// controlador I2C e divididos entre os dois, e confere que a GDDRAM
+// reconstruída a partir das transações é igual ao ram_buffer de cada painel e
+// que o ram_buffer (inclusive o byte emprestado como prefixo) volta intacto.
+// Cobre também o envio parcial, o NACK no meio do envio e a nova marcação das
+// colunas que não chegaram.
+
+#include <stdio.h>
+#include <string.h>
+#include "ssd1306.h"
+
+#define NUM_PAINEIS 3
+
+typedef struct {
+  ssd1306_controller_t controlador;
+  uint8_t altura, endereco;
+} painel_teste_t;
+
+static const painel_teste_t tipos[NUM_PAINEIS] = {
+  { SSD1306_CONTROLLER, 64, 0x3C },
+  { SSD1306_CONTROLLER, 32, 0x3D },
+  { SH1106_CONTROLLER, 64, 0x3E },
+};
+
+static ssd1306_t paineis[NUM_PAINEIS];
+static i2c_host_painel_t *simulados[NUM_PAINEIS];
+static ssd1306_t *lista[NUM_PAINEIS];
+static uint8_t copias[NUM_PAINEIS][WIDTH * HEIGHT / 8 + 1];
+static int falhas;
+
+static void falha(const char *etapa, const ssd1306_t *ssd, const char *motivo) {
+  printf("%s, %s %ux%u em 0x%02X: %s\n", etapa, ssd->controller == SH1106_CONTROLLER ? "SH1106" : "SSD1306",
+         ssd->width, ssd->height, ssd->address, motivo);
+  falhas++;
+}
+
+// A GDDRAM do painel simulado tem o conteúdo do framebuffer, deslocado pelas
+// colunas extras do SH1106
+static bool ram_confere(const ssd1306_t *ssd, const i2c_host_painel_t *p) {
+  for (uint8_t x = 0; x < ssd->width; ++x)
+    for (uint8_t page = 0; page < ssd->pages; ++page)
+      if (p->ram[page][x + ssd->col_offset] != ssd->ram_buffer[1 + x * ssd->pages + page])
+        return false;
+  return true;
+}
+
+// Um desenho diferente por painel e por rodada, limitado às colunas x0..x1
+static void desenhar(ssd1306_t *ssd, int rodada, uint8_t x0, uint8_t x1) {
+  for (uint8_t x = x0; x <= x1; ++x)
+    for (uint8_t y = 0; y < ssd->height; ++y)
+      ssd1306_pixel(ssd, x, y, (x * 3 + y * 5 + rodada + ssd->address) % 7 < 3);
+}
+
+// Envia e confere os painéis; os que estão em `falhando` devem ter recebido NACK
+static void enviar_e_conferir(const char *etapa, uint count, uint32_t falhando) {
+  for (uint i = 0; i < count; ++i)
+    memcpy(copias[i], paineis[i].ram_buffer, paineis[i].bufsize);
+
+  ssd1306_flush(lista, count);
+
+  for (uint i = 0; i < count; ++i) {
+    ssd1306_t *ssd = &paineis[i];
+    if (memcmp(copias[i], ssd->ram_buffer, ssd->bufsize) != 0)
+      falha(etapa, ssd, "ram_buffer alterado pelo envio");
+    if (falhando & (1u << i)) {
+      if (ssd->dirty_x0 > ssd->dirty_x1)
+        falha(etapa, ssd, "colunas abortadas nao foram marcadas de novo");
+    } else {
+      if (!ram_confere(ssd, simulados[i]))
+        falha(etapa, ssd, "GDDRAM diferente do ram_buffer");
+      if (ssd->dirty_x0 <= ssd->dirty_x1)
+        falha(etapa, ssd, "colunas ainda marcadas depois do envio");
+    }
+  }
+}
+
+static void testar(const char *nome, i2c_inst_t *const portas[NUM_PAINEIS]) {
+  printf("%s\n", nome);
+  i2c_host_reiniciar();
+
+  for (uint i = 0; i < NUM_PAINEIS; ++i) {
+    ssd1306_t *ssd = &paineis[i];
+    ssd1306_init_controller(ssd, tipos[i].controlador, WIDTH, tipos[i].altura, false, tipos[i].endereco, portas[i]);
+    simulados[i] = i2c_host_conectar(portas[i], tipos[i].endereco, tipos[i].controlador == SH1106_CONTROLLER);
+    lista[i] = ssd;
+    ssd1306_config(ssd);
+
+    // Configuração que depende da altura e do controlador
+    const i2c_host_painel_t *p = simulados[i];
+    if (p->comandos_invalidos)
+      falha("config", ssd, "comando que o controlador nao tem");
+    if (p->mux != ssd->height - 1 || p->com_pins != (ssd->height == 32 ? 0x02 : 0x12))
+      falha("config", ssd, "multiplex ou pinos COM errados para a altura");
+    if (!p->ligado)
+      falha("config", ssd, "display desligado");
+    if (ssd->controller == SSD1306_CONTROLLER && p->modo != 1)
+      falha("config", ssd, "SSD1306 fora do enderecamento vertical");
+  }
+
+  // Primeiro envio: o quadro inteiro de todos os painéis
+  for (uint i = 0; i < NUM_PAINEIS; ++i)
+    desenhar(&paineis[i], 0, 0, WIDTH - 1);
+  enviar_e_conferir("quadro inteiro", NUM_PAINEIS, 0);
+
+  // Envio parcial: o prefixo de dados é emprestado do byte antes da coluna 37
+  uint32_t antes[NUM_PAINEIS];
+  for (uint i = 0; i < NUM_PAINEIS; ++i) {
+    desenhar(&paineis[i], 1, 37, 52);
+    antes[i] = simulados[i]->bytes_dados;
+  }
+  enviar_e_conferir("colunas 37 a 52", NUM_PAINEIS, 0);
+  for (uint i = 0; i < NUM_PAINEIS; ++i)
+    if (simulados[i]->bytes_dados - antes[i] != 16u * paineis[i].pages)
+      falha("colunas 37 a 52", &paineis[i], "enviou colunas que nao mudaram");
+
+  // Nada alterado: nenhuma transação
+  for (uint i = 0; i < NUM_PAINEIS; ++i)
+    antes[i] = simulados[i]->transacoes;
+  if (ssd1306_flush(lista, NUM_PAINEIS)) {
+    printf("sem alteracoes: o envio informou transferencia\n");
+    falhas++;
+  }
+  for (uint i = 0; i < NUM_PAINEIS; ++i)
+    if (simulados[i]->transacoes != antes[i])
+      falha("sem alteracoes", &paineis[i], "houve transacao");
+
+  // NACK no painel do meio: ele guarda as colunas para o próximo envio e os
+  // outros seguem normalmente
+  for (uint i = 0; i < NUM_PAINEIS; ++i)
+    desenhar(&paineis[i], 2, 90, 120);
+  simulados[1]->falhar = true;
+  enviar_e_conferir("NACK no segundo painel", NUM_PAINEIS, 1u << 1);
+  if (paineis[1].dirty_x0 > 90 || paineis[1].dirty_x1 < 120)
+    falha("NACK no segundo painel", &paineis[1], "faixa marcada de novo nao cobre as colunas perdidas");
+  desenhar(&paineis[1], 3, 10, 20);
+  enviar_e_conferir("reenvio depois do NACK", NUM_PAINEIS, 0);
+
+  // O envio bloqueante usa o mesmo caminho das transações
+  for (uint i = 0; i < NUM_PAINEIS; ++i) {
+    desenhar(&paineis[i], 4, 0, WIDTH - 1);
+    ssd1306_send_data(&paineis[i]);
+    if (!ram_confere(&paineis[i], simulados[i]))
+      falha("envio bloqueante", &paineis[i], "GDDRAM diferente do ram_buffer");
+  }
+
+  for (uint i = 0; i < NUM_PAINEIS; ++i) {
+    free(paineis[i].ram_buffer);
+    free(paineis[i].page_buffer);
+  }
+}
+
+int main() {
+  static i2c_inst_t *const um_barramento[NUM_PAINEIS] = { i2c1, i2c1, i2c1 };
+  static i2c_inst_t *const dois_barramentos[NUM_PAINEIS] = { i2c1, i2c0, i2c0 };
+
+  testar("um barramento", um_barramento);
+  if (i2c_host_simultaneos != 0) {
+    printf("um barramento: transferencias simultaneas\n");
+    falhas++;
+  }
+
+  testar("dois barramentos", dois_barramentos);
+  if (i2c_host_simultaneos == 0) {
+    printf("dois barramentos: os controladores nao transferiram ao mesmo tempo\n");
+    falhas++;
+  }
+
+  printf("%d falha(s)\n", falhas);
+  return falhas ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+// Teste de host do planejador de rota: para conjuntos aleatórios de até 8
+// vítimas, compara o custo da programação dinâmica, executada em fatias
+// pequenas, com o melhor custo entre todas as ordens de visita, e confere que
+// a rota devolvida é uma permutação com esse custo.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "planejador.h"
+
+#define CONJUNTOS 40
+#define ORCAMENTO 7  // Fatias pequenas para atravessar vários quadros
+
+static planejador_t plano;
+static int posx[PLANEJADOR_MAX_PONTOS], posy[PLANEJADOR_MAX_PONTOS];
+
+static int distancia(int x0, int y0, int x1, int y1) {
+  int dx = abs(x0 - x1), dy = abs(y0 - y1);
+  return dx > dy ? dx : dy;
+}
+
+// Menor custo entre todas as ordens de visita das vítimas que faltam
+static int forca_bruta(int x, int y, uint32_t visitadas, int n) {
+  int melhor = -1;
+  for (int i = 0; i < n; ++i) {
+    if (visitadas & (1u << i))
+      continue;
+    int c = distancia(x, y, posx[i], posy[i]) + forca_bruta(posx[i], posy[i], visitadas | (1u << i), n);
+    if (melhor < 0 || c < melhor)
+      melhor = c;
+  }
+  return melhor < 0 ? 0 : melhor;
+}
+
+// Custo da rota devolvida, ou -1 se ela não visita cada vítima uma vez
+static int custo_rota(int origem_x, int origem_y, int n) {
+  uint32_t visitadas = 0;
+  int x = origem_x, y = origem_y, custo = 0;
+  for (int k = 0; k < n; ++k) {
+    uint8_t i = plano.rota[k];
+    if (i >= n || (visitadas & (1u << i)))
+      return -1;
+    visitadas |= 1u << i;
+    custo += distancia(x, y, posx[i], posy[i]);
+    x = posx[i];
+    y = posy[i];
+  }
+  return custo;
+}
+
+int main() {
+  int falhas = 0;
+  srand(4321);
+
+  for (int n = 1; n <= PLANEJADOR_MAX_PONTOS; n++) {
+    for (int c = 0; c < CONJUNTOS; c++) {
+      // Mesma faixa de posições que posicionar_vitimas() e posicionar_drone()
+      for (int i = 0; i < n; i++) {
+        posx[i] = (rand() % (118 - 4 + 1)) + 4;
+        posy[i] = (rand() % (59 - 12 + 1)) + 8;
+      }
+      int origem_x = (rand() % (118 - 8 + 1)) + 4;
+      int origem_y = (rand() % (54 - 8 + 1)) + 8;
+
+      planejador_iniciar(&plano, origem_x, origem_y, posx, posy, n);
+      while (!planejador_passo(&plano, ORCAMENTO))
+        ;
+
+      int otimo = forca_bruta(origem_x, origem_y, 0, n);
+      int rota = custo_rota(origem_x, origem_y, n);
+      if (plano.custo_total != otimo || rota != otimo) {
+        printf("n=%d conjunto %d: custo %u, rota %d, otimo %d\n", n, c, plano.custo_total, rota, otimo);
+        falhas++;
+      }
+    }
+  }
+
+  printf("%d conjunto(s) de 1 a %d vitimas, %d falha(s)\n", CONJUNTOS * PLANEJADOR_MAX_PONTOS,
+         PLANEJADOR_MAX_PONTOS, falhas);
+  return falhas ? 1 : 0;
+}
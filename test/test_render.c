@@ -0,0 +1,118 @@
+// Teste de regressão de render no host. Roda o roteiro de teste do jogo pelo
+// mesmo caminho da placa (replay -> mover_drone, verificar_resgate,
+// update_timer e um subquadro de dithering por passo) sobre o Pico SDK
+// simulado em test/host, e compara cada captura com a imagem PBM de
+// referência em test/golden. Sai com código 1 se alguma for diferente.
+// Imprime o tempo de cada passo, o médio e o pior, como o comando teste.
+//
+// Compilar e executar a partir da raiz do projeto:
+//   cmake -S test -B build-test && cmake --build build-test
+//   ctest --test-dir build-test --output-on-failure
+// Depois de uma mudança intencional no desenho, regravar as referências com:
+//   build-test/test_render --gravar
+
+#define main bitdog_main
+#include "BitDogRescue.c"
+#undef main
+
+// Lê uma imagem PBM em texto (P1) do tamanho esperado
+static bool ler_pbm(const char *caminho, uint8_t largura, uint8_t altura, bool *pixels) {
+  FILE *f = fopen(caminho, "r");
+  if (!f)
+    return false;
+
+  unsigned w, h;
+  bool ok = fscanf(f, " P1 %u %u", &w, &h) == 2 && w == largura && h == altura;
+  for (int i = 0; ok && i < largura * altura; ++i) {
+    int c;
+    while ((c = fgetc(f)) == ' ' || c == '\n' || c == '\r' || c == '\t')
+      ;
+    ok = c == '0' || c == '1';
+    pixels[i] = c == '1';
+  }
+  fclose(f);
+  return ok;
+}
+
+// Compara o framebuffer com a referência, empacotada nas páginas do display,
+// e aponta a primeira página e coluna diferentes como o comando teste da placa
+static bool comparar(const char *caminho, int passo) {
+  static bool pixels[WIDTH * HEIGHT];
+  static uint8_t esperado[WIDTH * HEIGHT / 8];
+  if (!ler_pbm(caminho, ssd.width, ssd.height, pixels)) {
+    printf(", referencia %s ausente ou invalida\n", caminho);
+    return false;
+  }
+
+  memset(esperado, 0, sizeof(esperado));
+  for (uint8_t y = 0; y < ssd.height; ++y)
+    for (uint8_t x = 0; x < ssd.width; ++x)
+      if (pixels[y * ssd.width + x])
+        esperado[x * ssd.pages + (y >> 3)] |= 1 << (y & 7);
+
+  uint8_t pagina, coluna;
+  if (snapshot_diff(esperado, ssd.ram_buffer + 1, ssd.pages, ssd.width, &pagina, &coluna)) {
+    char atual[64];
+    snprintf(atual, sizeof(atual), "passo_%02d.atual.pbm", passo);
+    FILE *f = fopen(atual, "w");
+    if (f) {
+      snapshot_write_pbm(f, &ssd);
+      fclose(f);
+    }
+    printf(", DIFERENTE na pagina %u, coluna %u (imagem obtida em %s)\n", pagina, coluna, atual);
+    return false;
+  }
+  printf(", igual\n");
+  return true;
+}
+
+int main(int argc, char **argv) {
+  bool gravar = argc >= 2 && strcmp(argv[1], "--gravar") == 0;
+  const roteiro_t *r = &roteiro_teste;
+
+  ssd1306_init(&ssd, WIDTH, HEIGHT, false, ENDERECO, I2C_PORT);
+  trava_vitimas = spin_lock_instance(spin_lock_claim_unused(true));
+  carregar_roteiro(r);
+
+  int passos = passos_gravados;
+  int falhas = 0;
+  uint8_t captura = 0;
+  uint32_t total_us = 0, pior_us = 0;
+
+  for (int passo = 0; passo < passos; passo++) {
+    uint32_t passo_us = passo_roteiro(passo);
+    total_us += passo_us;
+    pior_us = MAX(pior_us, passo_us);
+
+    printf("passo %d: %lu us", passo, (unsigned long)passo_us);
+    if (captura >= r->num_capturas || passo != r->capturas[captura]) {
+      printf("\n");
+      continue;
+    }
+
+    char caminho[256];
+    snprintf(caminho, sizeof(caminho), "%s/passo_%02d.pbm", GOLDEN_DIR, passo);
+    if (gravar) {
+      FILE *f = fopen(caminho, "w");
+      if (!f) {
+        printf(", nao foi possivel gravar %s\n", caminho);
+        return 1;
+      }
+      snapshot_write_pbm(f, &ssd);
+      fclose(f);
+      printf(", gravado em %s\n", caminho);
+    } else if (!comparar(caminho, passo)) {
+      falhas++;
+    }
+    captura++;
+  }
+  encerrar_roteiro();
+
+  if (captura != r->num_capturas) {
+    printf("o roteiro terminou antes da captura %u\n", captura);
+    return 1;
+  }
+  printf("%d passos, medio %lu us, pior %lu us, %d captura(s) diferente(s)\n", passos,
+         (unsigned long)(total_us / passos), (unsigned long)pior_us, falhas);
+  return falhas ? 1 : 0;
+}
@@ -0,0 +1,66 @@
+// Teste de host das capturas de referência na flash (simulada em RAM por
+// test/host): grava e relê capturas de painéis com geometrias diferentes,
+// inclusive uma que não ocupa páginas inteiras da flash.
+
+#include <stdio.h>
+#include "snapshot.h"
+
+typedef struct {
+  uint8_t width, height;
+} geometria_t;
+
+static const geometria_t geometrias[] = {
+  { 128, 64 },  // 1024 bytes, o display da placa
+  { 128, 32 },  // 512 bytes
+  { 64, 48 },   // 384 bytes, sobra meia página
+};
+
+static int testar(const geometria_t *g) {
+  ssd1306_t ssd;
+  ssd1306_init(&ssd, g->width, g->height, false, 0x3C, i2c1);
+
+  snapshot_golden_erase();
+  uint8_t gravadas = 0;
+  for (uint8_t i = 0; i < SNAPSHOT_MAX_GOLDEN; ++i) {
+    // Um padrão diferente por captura
+    for (uint8_t x = 0; x < ssd.width; ++x)
+      for (uint8_t y = 0; y < ssd.height; ++y)
+        ssd1306_pixel(&ssd, x, y, (x * 7 + y * 3 + i) % 5 == 0);
+    if (!snapshot_golden_store(i, &ssd))
+      break;
+    gravadas++;
+  }
+
+  snapshot_header_t header = { .magic = SNAPSHOT_MAGIC, .frame_size = snapshot_frame_size(&ssd), .count = gravadas };
+  snapshot_golden_finish(&header);
+
+  int falhas = 0;
+  for (uint8_t i = 0; i < gravadas; ++i) {
+    for (uint8_t x = 0; x < ssd.width; ++x)
+      for (uint8_t y = 0; y < ssd.height; ++y)
+        ssd1306_pixel(&ssd, x, y, (x * 7 + y * 3 + i) % 5 == 0);
+
+    uint8_t pagina, coluna;
+    const uint8_t *golden = snapshot_golden_frame(i);
+    if (!golden || snapshot_diff(golden, ssd.ram_buffer + 1, ssd.pages, ssd.width, &pagina, &coluna)) {
+      printf("%ux%u captura %u: DIFERENTE\n", g->width, g->height, i);
+      falhas++;
+    }
+  }
+  if (snapshot_golden_frame(gravadas) != NULL) {
+    printf("%ux%u: captura %u alem das gravadas\n", g->width, g->height, gravadas);
+    falhas++;
+  }
+
+  printf("%ux%u: %u captura(s) de %u bytes, %d falha(s)\n", g->width, g->height, gravadas,
+         snapshot_frame_size(&ssd), falhas);
+  free(ssd.ram_buffer);
+  return falhas;
+}
+
+int main() {
+  int falhas = 0;
+  for (size_t i = 0; i < sizeof(geometrias) / sizeof(geometrias[0]); ++i)
+    falhas += testar(&geometrias[i]);
+  return falhas ? 1 : 0;
+}